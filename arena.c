@@ -0,0 +1,68 @@
+/* Bump allocator for the config.
+ *
+ * A config generation (the config.json buffer, its rules, keys, buttons and
+ * tags) is carved out of a few large blocks. Strings are not copied: nxjson
+ * unescapes them in place, so they point into the buffer, which is kept for
+ * as long as the generation lives. Dropping a generation frees its blocks
+ * and nothing else, and the parse tree gets a scratch arena of its own that
+ * is dropped right after parsing. */
+#define ARENABLOCK  (16 * 1024)
+#define ARENAALIGN  8
+
+typedef struct ArenaBlock ArenaBlock;
+struct ArenaBlock {
+	ArenaBlock *next;
+	size_t used, size;
+	char data[];
+};
+
+typedef struct {
+	ArenaBlock *blocks;
+} Arena;
+
+static Arena configarena = { NULL };
+static Arena parsearena = { NULL };
+
+static void *
+arenaalloc(Arena *a, size_t size) {
+	ArenaBlock *b = a->blocks;
+	size_t n;
+	void *p;
+
+	size = (size + ARENAALIGN - 1) & ~(size_t)(ARENAALIGN - 1);
+	if(!b || b->size - b->used < size) {
+		n = MAX(ARENABLOCK, size);
+		if(!(b = malloc(sizeof(ArenaBlock) + n)))
+			die("fatal: could not malloc() %u bytes\n", sizeof(ArenaBlock) + n);
+		b->used = 0;
+		b->size = n;
+		/* a big allocation gets its own block without retiring the current one */
+		if(a->blocks && n > ARENABLOCK) {
+			b->next = a->blocks->next;
+			a->blocks->next = b;
+		}
+		else {
+			b->next = a->blocks;
+			a->blocks = b;
+		}
+	}
+	p = b->data + b->used;
+	b->used += size;
+	memset(p, 0, size);
+	return p;
+}
+
+static char *
+arenastrdup(Arena *a, const char *s) {
+	return strcpy(arenaalloc(a, strlen(s) + 1), s);
+}
+
+static void
+freearena(Arena *a) {
+	ArenaBlock *b;
+
+	while((b = a->blocks)) {
+		a->blocks = b->next;
+		free(b);
+	}
+}
@@ -0,0 +1,102 @@
+#!/bin/sh
+# Runs dwm-bench on a private Xvfb display and drives it with stormclient.
+# usage: bench/bench.sh [windows] [rules]
+# The dwm counters of each scenario are kept in bench/<scenario>.json.
+# BENCHDWM picks another binary; BENCHSTATS=0 skips the counters for builds
+# without -DSTATS (make pgo trains that way).
+
+cd "$(dirname "$0")/.." || exit 1
+BENCHDISPLAY=${BENCHDISPLAY:-:97}
+WINDOWS=${1:-500}
+RULES=${2:-300}
+BENCHDWM=${BENCHDWM:-./dwm-bench}
+BENCHSTATS=${BENCHSTATS:-1}
+STATS=/tmp/dwm-stats.json # statsfile in config.h
+WORK=$(mktemp -d)
+XPID=
+WMPID=
+
+# dwm leaves through exit() once the server is gone, which is when a
+# -fprofile-generate build writes its profile
+stop() {
+	[ -n "$XPID" ] && kill $XPID 2>/dev/null && wait $XPID 2>/dev/null
+	if [ -n "$WMPID" ]; then
+		sleep 1
+		kill $WMPID 2>/dev/null
+		wait $WMPID 2>/dev/null
+	fi
+	WMPID=
+	XPID=
+}
+trap 'stop; rm -rf "$WORK"' EXIT INT TERM
+
+# config.json with a rule per benchmark tag plus <rules> filler rules that
+# never match, so every manage() walks the whole list
+genconfig() {
+	mkdir -p "$WORK/.config/dwm"
+	{
+		printf '{\n\t"font": "Monospace 10",\n'
+		printf '\t"tags": [ "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "v" ],\n'
+		printf '\t"keys": [\n'
+		printf '\t\t{ "key": "j", "modifiers": [ "mod4" ], "action": { "function": "focusstack", "arg": 1 } },\n'
+		printf '\t\t{ "key": "k", "modifiers": [ "mod4" ], "action": { "function": "focusstack", "arg": -1 } },\n'
+		printf '\t\t{ "key": "t", "modifiers": [ "mod4" ], "action": { "function": "setlayout", "arg": "tile" } },\n'
+		printf '\t\t{ "key": "m", "modifiers": [ "mod4" ], "action": { "function": "setlayout", "arg": "monocle" } },\n'
+		printf '\t\t{ "key": "Tab", "modifiers": [ "mod4" ], "action": { "function": "view" } }\n'
+		printf '\t],\n'
+		printf '\t"rules": [\n'
+		i=0
+		while [ $i -lt $1 ]; do
+			printf '\t\t{ "class": "filler%d", "instance": "filler%d", "title": "filler %d", "isfloating": 1 },\n' $i $i $i
+			i=$((i + 1))
+		done
+		i=0
+		while [ $i -lt 9 ]; do
+			printf '\t\t{ "class": "bench-t%d", "tag": %d },\n' $i $((i + 1))
+			i=$((i + 1))
+		done
+		printf '\t\t{ "class": "bench-t9", "tag": 10 }\n\t]\n}\n'
+	} > "$WORK/.config/dwm/config.json"
+}
+
+# scenario <name> <rules> <Xvfb screen arguments...>
+scenario() {
+	name=$1
+	genconfig $2
+	shift 2
+	echo "== $name"
+	Xvfb $BENCHDISPLAY -nolisten tcp "$@" >"$WORK/xvfb.log" 2>&1 &
+	XPID=$!
+	sleep 1
+	rm -f $STATS
+	HOME=$WORK DISPLAY=$BENCHDISPLAY $BENCHDWM >"$WORK/dwm.log" 2>&1 &
+	WMPID=$!
+	DISPLAY=$BENCHDISPLAY bench/stormclient $WINDOWS || status=1
+	if [ "$BENCHSTATS" = 0 ]; then
+		stop
+		return
+	fi
+	# the dump happens on the next event dwm wakes up for
+	kill -USR1 $WMPID
+	DISPLAY=$BENCHDISPLAY bench/stormclient poke
+	n=0
+	while ! tail -n 1 $STATS 2>/dev/null | grep -q '^}' && [ $n -lt 50 ]; do
+		sleep 0.1
+		n=$((n + 1))
+	done
+	if [ -f $STATS ]; then
+		cp $STATS bench/$name.json
+		grep -E '"(requests|roundtrips|xsyncs|arrange|drawbar|restackwindows)"' $STATS \
+			| sed 's/[",]//g; s/^[[:space:]]*/dwm /'
+	else
+		echo "no counters from dwm-bench"
+		status=1
+	fi
+	stop
+}
+
+status=0
+scenario single 0 -screen 0 1920x1080x24
+scenario rules $RULES -screen 0 1920x1080x24
+scenario dual 0 -screen 0 1920x1080x24 -screen 1 1920x1080x24 +xinerama
+exit $status
@@ -0,0 +1,355 @@
+/* See LICENSE file for copyright and license details.
+ *
+ * stormclient drives a running dwm through plain X requests and reports
+ * latency percentiles for the window manager's reactions:
+ *
+ *   map      MapRequest until the managed window is mapped (MapNotify)
+ *   title    a burst of WM_NAME/_NET_WM_NAME changes, until dwm caught up
+ *   view     _NET_ACTIVE_WINDOW on another tag until the client is focused
+ *   focus    _NET_ACTIVE_WINDOW within the current tag until FocusIn
+ *   keys     XTest key bindings (focusstack, setlayout, view), until dwm
+ *            caught up
+ *
+ * usage: stormclient [windows]   run all workloads
+ *        stormclient poke        map and unmap a single window
+ *
+ * Windows are told apart by WM_CLASS; bench.sh generates rules that put
+ * "bench-t<n>" on tag n + 1 and the Mod4 key bindings used here.
+ */
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xcb/xcb.h>
+#include <xcb/xtest.h>
+
+#define TIMEOUT   2000 /* ms to wait for dwm before counting a miss */
+#define NUMVIEWS  10   /* dwm never activates into the last (v) tag */
+#define TITLES    2000
+#define ROUNDS    200
+#define KEYS      1000
+
+enum { NetActiveWindow, NetWMName, NetSupported, Utf8String, AtomLast };
+
+static const char *atomnames[AtomLast] = {
+	[NetActiveWindow] = "_NET_ACTIVE_WINDOW",
+	[NetWMName] = "_NET_WM_NAME",
+	[NetSupported] = "_NET_SUPPORTED",
+	[Utf8String] = "UTF8_STRING",
+};
+
+static xcb_connection_t *conn;
+static xcb_screen_t *scr;
+static xcb_atom_t atoms[AtomLast];
+static unsigned int misses = 0;
+
+static void
+die(const char *msg) {
+	fprintf(stderr, "stormclient: %s\n", msg);
+	exit(EXIT_FAILURE);
+}
+
+static double
+now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int
+cmpdouble(const void *a, const void *b) {
+	double d = *(const double *)a - *(const double *)b;
+
+	return (d > 0) - (d < 0);
+}
+
+static void
+report(const char *name, double *samples, int n) {
+	if(!n) {
+		printf("%-8s no samples\n", name);
+		return;
+	}
+	qsort(samples, n, sizeof(double), cmpdouble);
+	printf("%-8s n=%-5d p50=%.3fms p90=%.3fms p99=%.3fms max=%.3fms\n", name, n,
+	       samples[n / 2], samples[n * 9 / 10], samples[n * 99 / 100], samples[n - 1]);
+}
+
+static void
+internatoms(void) {
+	xcb_intern_atom_cookie_t cookies[AtomLast];
+	xcb_intern_atom_reply_t *r;
+	int i;
+
+	for(i = 0; i < AtomLast; ++i)
+		cookies[i] = xcb_intern_atom(conn, 0, strlen(atomnames[i]), atomnames[i]);
+	for(i = 0; i < AtomLast; ++i) {
+		if(!(r = xcb_intern_atom_reply(conn, cookies[i], NULL)))
+			die("cannot intern atoms");
+		atoms[i] = r->atom;
+		free(r);
+	}
+}
+
+/* dwm advertises _NET_SUPPORTED once setup() is done */
+static void
+waitwm(void) {
+	xcb_get_property_reply_t *r;
+	int i, found;
+
+	for(i = 0; i < 100; ++i) {
+		r = xcb_get_property_reply(conn, xcb_get_property(conn, 0, scr->root,
+		                           atoms[NetSupported], XCB_ATOM_ATOM, 0, 1), NULL);
+		found = r && r->value_len;
+		free(r);
+		if(found)
+			return;
+		nanosleep(&(struct timespec){ 0, 50000000 }, NULL);
+	}
+	die("no window manager running");
+}
+
+/* wait for an event of type on win, dropping everything else */
+static int
+waitfor(xcb_window_t win, int type) {
+	struct pollfd pfd = { xcb_get_file_descriptor(conn), POLLIN, 0 };
+	xcb_generic_event_t *ev;
+	xcb_window_t evwin;
+	double deadline = now() + TIMEOUT;
+	int evtype;
+
+	xcb_flush(conn);
+	for(;;) {
+		while((ev = xcb_poll_for_event(conn))) {
+			evtype = ev->response_type & ~0x80;
+			switch(evtype) {
+			case XCB_MAP_NOTIFY:
+				evwin = ((xcb_map_notify_event_t *)ev)->window;
+				break;
+			case XCB_FOCUS_IN:
+				evwin = ((xcb_focus_in_event_t *)ev)->event;
+				break;
+			default:
+				evwin = XCB_NONE;
+				break;
+			}
+			free(ev);
+			if(evtype == type && evwin == win)
+				return 1;
+		}
+		if(xcb_connection_has_error(conn))
+			die("connection lost");
+		if(now() >= deadline || poll(&pfd, 1, TIMEOUT) <= 0) {
+			misses++;
+			return 0;
+		}
+	}
+}
+
+static xcb_window_t
+createwin(const char *class) {
+	xcb_window_t win = xcb_generate_id(conn);
+	uint32_t mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE;
+	char wmclass[64];
+	int len;
+
+	xcb_create_window(conn, XCB_COPY_FROM_PARENT, win, scr->root, 0, 0, 200, 100, 0,
+	                  XCB_WINDOW_CLASS_INPUT_OUTPUT, scr->root_visual, XCB_CW_EVENT_MASK, &mask);
+	len = snprintf(wmclass, sizeof wmclass, "%s%c%s", class, '\0', class) + 1;
+	xcb_change_property(conn, XCB_PROP_MODE_REPLACE, win, XCB_ATOM_WM_CLASS,
+	                    XCB_ATOM_STRING, 8, len, wmclass);
+	return win;
+}
+
+static double
+mapwin(xcb_window_t win) {
+	double start = now();
+
+	xcb_map_window(conn, win);
+	return waitfor(win, XCB_MAP_NOTIFY) ? now() - start : -1;
+}
+
+static double
+activate(xcb_window_t win) {
+	xcb_client_message_event_t cm = { 0 };
+	double start = now();
+
+	cm.response_type = XCB_CLIENT_MESSAGE;
+	cm.format = 32;
+	cm.window = win;
+	cm.type = atoms[NetActiveWindow];
+	cm.data.data32[0] = 2; /* source indication: pager */
+	xcb_send_event(conn, 0, scr->root, XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT
+	               | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (const char *)&cm);
+	return waitfor(win, XCB_FOCUS_IN) ? now() - start : -1;
+}
+
+/* a window dwm has to manage before it can answer, so everything queued
+ * ahead of it has been handled once it is mapped */
+static double
+barrier(void) {
+	xcb_window_t win = createwin("bench-barrier");
+	double t = mapwin(win);
+
+	xcb_destroy_window(conn, win);
+	return t;
+}
+
+static void
+mapstorm(int n) {
+	xcb_window_t *wins = calloc(n, sizeof(xcb_window_t));
+	double *samples = calloc(n, sizeof(double));
+	double t, start;
+	int i, ns = 0;
+
+	if(!wins || !samples)
+		die("out of memory");
+	for(i = 0; i < n; ++i) {
+		wins[i] = createwin("bench-map");
+		if((t = mapwin(wins[i])) >= 0)
+			samples[ns++] = t;
+	}
+	report("map", samples, ns);
+	start = now();
+	for(i = 0; i < n; ++i)
+		xcb_unmap_window(conn, wins[i]);
+	barrier();
+	printf("%-8s n=%-5d total=%.3fms\n", "unmap", n, now() - start);
+	for(i = 0; i < n; ++i)
+		xcb_destroy_window(conn, wins[i]);
+	free(samples);
+	free(wins);
+}
+
+static void
+titlestorm(void) {
+	xcb_window_t win = createwin("bench-title");
+	char title[32];
+	double start;
+	int i, len;
+
+	mapwin(win);
+	start = now();
+	for(i = 0; i < TITLES; ++i) {
+		len = snprintf(title, sizeof title, "title %d", i);
+		xcb_change_property(conn, XCB_PROP_MODE_REPLACE, win, XCB_ATOM_WM_NAME,
+		                    XCB_ATOM_STRING, 8, len, title);
+		xcb_change_property(conn, XCB_PROP_MODE_REPLACE, win, atoms[NetWMName],
+		                    atoms[Utf8String], 8, len, title);
+	}
+	barrier();
+	printf("%-8s n=%-5d total=%.3fms\n", "title", TITLES, now() - start);
+	xcb_destroy_window(conn, win);
+}
+
+static void
+switchstorm(void) {
+	xcb_window_t views[NUMVIEWS], local[4];
+	double vs[ROUNDS], fs[ROUNDS], t;
+	char class[16];
+	int i, nv = 0, nf = 0;
+
+	for(i = 0; i < NUMVIEWS; ++i) {
+		snprintf(class, sizeof class, "bench-t%d", i);
+		mapwin(views[i] = createwin(class));
+	}
+	for(i = 0; i < ROUNDS; ++i)
+		if((t = activate(views[i % NUMVIEWS])) >= 0)
+			vs[nv++] = t;
+	report("view", vs, nv);
+	for(i = 0; i < 4; ++i)
+		mapwin(local[i] = createwin("bench-t0"));
+	activate(local[0]);
+	for(i = 0; i < ROUNDS; ++i)
+		if((t = activate(local[(i + 1) % 4])) >= 0)
+			fs[nf++] = t;
+	report("focus", fs, nf);
+	for(i = 0; i < NUMVIEWS; ++i)
+		xcb_destroy_window(conn, views[i]);
+	for(i = 0; i < 4; ++i)
+		xcb_destroy_window(conn, local[i]);
+}
+
+static xcb_keycode_t
+keycode(xcb_keysym_t sym) {
+	const xcb_setup_t *setup = xcb_get_setup(conn);
+	xcb_get_keyboard_mapping_reply_t *r;
+	xcb_keysym_t *syms;
+	xcb_keycode_t code = 0;
+	int i, n;
+
+	r = xcb_get_keyboard_mapping_reply(conn, xcb_get_keyboard_mapping(conn, setup->min_keycode,
+	                                   setup->max_keycode - setup->min_keycode + 1), NULL);
+	if(!r)
+		return 0;
+	syms = xcb_get_keyboard_mapping_keysyms(r);
+	n = xcb_get_keyboard_mapping_keysyms_length(r);
+	for(i = 0; i < n && !code; ++i)
+		if(syms[i] == sym)
+			code = setup->min_keycode + i / r->keysyms_per_keycode;
+	free(r);
+	return code;
+}
+
+static void
+fakekey(xcb_keycode_t mod, xcb_keycode_t key) {
+	xcb_test_fake_input(conn, XCB_KEY_PRESS, mod, XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+	xcb_test_fake_input(conn, XCB_KEY_PRESS, key, XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+	xcb_test_fake_input(conn, XCB_KEY_RELEASE, key, XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+	xcb_test_fake_input(conn, XCB_KEY_RELEASE, mod, XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+}
+
+static void
+keystorm(void) {
+	static const xcb_keysym_t syms[] = {
+		0x006a /* j */, 0x006a, 0x006b /* k */, 0x006d /* m */, 0x006a,
+		0x0074 /* t */, 0xff09 /* Tab */, 0xff09,
+	};
+	xcb_keycode_t mod = keycode(0xffeb /* Super_L */), codes[sizeof syms / sizeof syms[0]];
+	xcb_window_t wins[8];
+	double start;
+	int i, n = sizeof syms / sizeof syms[0];
+
+	for(i = 0; i < n; ++i)
+		if(!(codes[i] = keycode(syms[i])) || !mod) {
+			printf("%-8s keys not in the keymap\n", "keys");
+			return;
+		}
+	for(i = 0; i < 8; ++i)
+		mapwin(wins[i] = createwin("bench-keys"));
+	start = now();
+	for(i = 0; i < KEYS; ++i)
+		fakekey(mod, codes[i % n]);
+	barrier();
+	printf("%-8s n=%-5d total=%.3fms\n", "keys", KEYS, now() - start);
+	for(i = 0; i < 8; ++i)
+		xcb_destroy_window(conn, wins[i]);
+}
+
+int
+main(int argc, char *argv[]) {
+	int n = 500;
+
+	conn = xcb_connect(NULL, NULL);
+	if(xcb_connection_has_error(conn))
+		die("cannot open display");
+	scr = xcb_setup_roots_iterator(xcb_get_setup(conn)).data;
+	internatoms();
+	waitwm();
+	if(argc > 1 && !strcmp(argv[1], "poke")) {
+		barrier();
+		xcb_disconnect(conn);
+		return EXIT_SUCCESS;
+	}
+	if(argc > 1 && (n = atoi(argv[1])) <= 0)
+		die("usage: stormclient [windows|poke]");
+	mapstorm(n);
+	titlestorm();
+	switchstorm();
+	keystorm();
+	if(misses)
+		printf("%u waits timed out\n", misses);
+	xcb_disconnect(conn);
+	return misses ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+/* Clients are carved out of slabs instead of being calloc'd one by one, so
+ * that the hot part of every client stays packed together in memory while
+ * list walks (ISVISIBLE, nexttiled) run. The cold ClientInfo of a slab lives
+ * in its own array and is only read on title, hint and rule updates. */
+#define CLIENTSLABSIZE 64
+
+typedef struct ClientSlab ClientSlab;
+struct ClientSlab {
+	Client clients[CLIENTSLABSIZE];
+	ClientInfo infos[CLIENTSLABSIZE];
+	ClientSlab *next;
+};
+
+static ClientSlab *clientslabs = NULL;
+static Client *freeclients = NULL;
+
+void
+growclientpool(void) {
+	ClientSlab *s;
+	int i;
+
+	if(!(s = (ClientSlab *)calloc(1, sizeof(ClientSlab))))
+		die("fatal: could not malloc() %u bytes\n", sizeof(ClientSlab));
+	s->next = clientslabs;
+	clientslabs = s;
+	for(i = CLIENTSLABSIZE - 1; i >= 0; --i) {
+		s->clients[i].info = &s->infos[i];
+		s->clients[i].next = freeclients;
+		freeclients = &s->clients[i];
+	}
+}
+
+Client *
+allocclient(void) {
+	Client *c;
+	ClientInfo *info;
+
+	if(!freeclients)
+		growclientpool();
+	c = freeclients;
+	freeclients = c->next;
+	info = c->info;
+	memset(c, 0, sizeof(Client));
+	memset(info, 0, sizeof(ClientInfo));
+	c->info = info;
+	return c;
+}
+
+void
+freeclient(Client *c) {
+	untrackclient(c);
+	c->next = freeclients;
+	freeclients = c;
+}
+
+void
+cleanupclientpool(void) {
+	ClientSlab *s;
+
+	while(clientslabs) {
+		s = clientslabs;
+		clientslabs = s->next;
+		free(s);
+	}
+	freeclients = NULL;
+}
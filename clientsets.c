@@ -0,0 +1,102 @@
+/* Clients with a special focus role are kept in small sets, so focus() and
+ * restackwindows() look at them directly instead of scanning every client
+ * of every monitor. trackclient() recomputes the membership of a client from
+ * its flags and is called wherever rules or window types set them; the
+ * client pool drops a client from all sets when it is freed. The sets are in
+ * insertion order; where the order matters it is put back to the one of the
+ * monitor and client lists. */
+typedef struct {
+	Client **v;
+	int n, size;
+} ClientSet;
+
+static ClientSet exfocusclients;  /* exclusive focus, win over any other */
+static ClientSet nofocusclients;  /* never focused, stacked under the rest */
+static ClientSet osdclients;      /* notifications and OSDs, stacked on top */
+
+static void
+setremove(ClientSet *s, Client *c) {
+	int i;
+
+	for(i = 0; i < s->n; ++i)
+		if(s->v[i] == c) {
+			memmove(&s->v[i], &s->v[i + 1], (s->n - i - 1) * sizeof(Client *));
+			--s->n;
+			return;
+		}
+}
+
+static void
+setinclude(ClientSet *s, Client *c, Bool include) {
+	setremove(s, c);
+	if(!include)
+		return;
+	if(s->n == s->size) {
+		s->size = s->size ? s->size * 2 : 8;
+		if(!(s->v = realloc(s->v, s->size * sizeof(Client *))))
+			die("fatal: could not malloc() %u bytes\n", s->size * sizeof(Client *));
+	}
+	s->v[s->n++] = c;
+}
+
+/* whether a comes after b walking mons and their client or stack lists */
+static Bool
+clientafter(Client *a, Client *b, Bool stack) {
+	Monitor *m;
+	Client *c;
+
+	if(a->mon != b->mon) {
+		for(m = mons; m && m != a->mon && m != b->mon; m = m->next);
+		return m && m == b->mon;
+	}
+	for(c = stack ? a->mon->stack : a->mon->clients; c && c != a && c != b;
+	    c = stack ? c->snext : c->next);
+	return c && c == b;
+}
+
+/* insertion sort, the sets hold a handful of clients */
+void
+sortclientset(ClientSet *s, Bool stack) {
+	Client *c;
+	int i, j;
+
+	for(i = 1; i < s->n; ++i) {
+		c = s->v[i];
+		for(j = i; j > 0 && clientafter(s->v[j - 1], c, stack); --j)
+			s->v[j] = s->v[j - 1];
+		s->v[j] = c;
+	}
+}
+
+/* the visible exfocus client that comes last in the client lists */
+Client *
+exfocusclient(void) {
+	Client *c = NULL;
+	int i;
+
+	for(i = 0; i < exfocusclients.n; ++i)
+		if(ISVISIBLE(exfocusclients.v[i]) && (!c || clientafter(exfocusclients.v[i], c, False)))
+			c = exfocusclients.v[i];
+	return c;
+}
+
+void
+trackclient(Client *c) {
+	setinclude(&exfocusclients, c, c->exfocus);
+	setinclude(&nofocusclients, c, c->nofocus);
+	setinclude(&osdclients, c, c->isosd);
+}
+
+void
+untrackclient(Client *c) {
+	setremove(&exfocusclients, c);
+	setremove(&nofocusclients, c);
+	setremove(&osdclients, c);
+}
+
+void
+cleanupclientsets(void) {
+	free(exfocusclients.v);
+	free(nofocusclients.v);
+	free(osdclients.v);
+}
@@ -0,0 +1,158 @@
+/* Desktop clock.
+ *
+ * Each monitor gets an analog clock drawn by dwm into a small override-redirect
+ * window centred on its window area and kept at the bottom of the stack,
+ * where oclock used to run as a separate client. A single timerfd, armed on
+ * the next wall-clock minute (second with clockseconds) boundary, is polled
+ * next to the X connection in run(); a tick repaints just the clock windows. */
+#include <math.h>
+#include <sys/timerfd.h>
+
+static int clockfd = -1;
+
+static void
+setclocksource(cairo_t *cr, const PangoColor *color) {
+	cairo_set_source_rgb(cr, color->red / 65535., color->green / 65535., color->blue / 65535.);
+}
+
+static void
+drawhand(cairo_t *cr, double turns, double length, double width) {
+	cairo_set_line_width(cr, width);
+	cairo_move_to(cr, 0, 0);
+	cairo_line_to(cr, length * sin(turns * 2 * M_PI), -length * cos(turns * 2 * M_PI));
+	cairo_stroke(cr);
+}
+
+void
+drawclock(Monitor *m) {
+	cairo_surface_t *cs;
+	cairo_t *cr;
+	time_t now;
+	struct tm *tm;
+	double r = clocksize / 2.;
+	int i;
+
+	if(!m->clock || m->fullscreenwin)
+		return;
+	now = time(NULL);
+	tm = localtime(&now);
+	cs = cairo_xlib_surface_create(dpy, m->clock, DefaultVisual(dpy, screen), clocksize, clocksize);
+	cr = cairo_create(cs);
+	cairo_push_group(cr);
+	setclocksource(cr, &dc.pangonorm[ColBG]);
+	cairo_paint(cr);
+	cairo_translate(cr, r, r);
+	cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+	setclocksource(cr, &dc.pangonorm[ColFG]);
+	for(i = 0; i < 12; ++i) {
+		cairo_set_line_width(cr, i % 3 ? r / 60 : r / 30);
+		cairo_move_to(cr, 0.85 * r * sin(i * M_PI / 6), -0.85 * r * cos(i * M_PI / 6));
+		cairo_line_to(cr, 0.95 * r * sin(i * M_PI / 6), -0.95 * r * cos(i * M_PI / 6));
+		cairo_stroke(cr);
+	}
+	drawhand(cr, (tm->tm_hour % 12 + tm->tm_min / 60.) / 12, 0.5 * r, r / 15);
+	drawhand(cr, (tm->tm_min + (clockseconds ? tm->tm_sec / 60. : 0)) / 60, 0.8 * r, r / 25);
+	if(clockseconds) {
+		setclocksource(cr, &dc.pangosel[ColBG]);
+		drawhand(cr, tm->tm_sec / 60., 0.9 * r, r / 60);
+	}
+	cairo_pop_group_to_source(cr);
+	cairo_identity_matrix(cr);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+	cairo_surface_destroy(cs);
+}
+
+void
+drawclocks(void) {
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		drawclock(m);
+}
+
+static void
+armclock(void) {
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+	time_t period = clockseconds ? 1 : 60;
+
+	its.it_value.tv_sec = (time(NULL) / period + 1) * period;
+	timerfd_settime(clockfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+void
+tickclocks(void) {
+	uint64_t expirations;
+
+	if(read(clockfd, &expirations, sizeof expirations) != sizeof expirations)
+		return;
+	drawclocks();
+	XFlush(dpy);
+	armclock();
+}
+
+void
+createclock(Monitor *m) {
+	XSetWindowAttributes wa = {
+		.override_redirect = True,
+		.background_pixel = dc.norm[ColBG],
+		.event_mask = ExposureMask
+	};
+
+	if(m->clock || clocksize <= 0)
+		return;
+	m->clock = XCreateWindow(dpy, root, m->wx + (m->ww - clocksize) / 2, m->wy + (m->wh - clocksize) / 2,
+	                         clocksize, clocksize, 0, DefaultDepth(dpy, screen), CopyFromParent,
+	                         DefaultVisual(dpy, screen), CWOverrideRedirect|CWBackPixel|CWEventMask, &wa);
+	window_opacity_set(m->clock, OPACITY_BYTES(clockopacity));
+	XLowerWindow(dpy, m->clock);
+	XMapWindow(dpy, m->clock);
+	if(clockfd == -1 && (clockfd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK|TFD_CLOEXEC)) != -1)
+		armclock();
+}
+
+void
+createclocks(void) {
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		createclock(m);
+}
+
+/* follows a monitor that moved or changed size */
+void
+moveclock(Monitor *m) {
+	if(!m->clock) {
+		createclock(m);
+		return;
+	}
+	XMoveResizeWindow(dpy, m->clock, m->wx + (m->ww - clocksize) / 2, m->wy + (m->wh - clocksize) / 2,
+	                  clocksize, clocksize);
+}
+
+void
+destroyclock(Monitor *m) {
+	if(!m->clock)
+		return;
+	XDestroyWindow(dpy, m->clock);
+	m->clock = 0;
+}
+
+void
+killclocks(void) {
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		destroyclock(m);
+	if(clockfd != -1)
+		close(clockfd);
+	clockfd = -1;
+}
+
+Monitor *
+clocktomon(Window w) {
+	Monitor *m;
+
+	for(m = mons; m && m->clock != w; m = m->next);
+	return w ? m : NULL;
+}
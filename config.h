@@ -17,7 +17,8 @@ static const unsigned int trrnttag = 1 << 6;
 static const unsigned int musictag = 1 << 7;
 static const unsigned int misctag = 1 << 8;
 static const unsigned int webtag = 1 << 9;
-static unsigned int vtag = 1 << 10;
+#define DEFAULT_VTAG (1 << 10)
+static unsigned int vtag = DEFAULT_VTAG;
 
 static const unsigned int anytag = 0;
 static const unsigned int alltags = ~0;
@@ -32,8 +33,11 @@ typedef enum {
 	Left,
 	Right
 } ScreenSide;
-static ScreenSide dockposition = Bottom;
-static int dockmonitor = 0;
+#define DEFAULT_DOCKPOSITION Bottom
+#define DEFAULT_DOCKMONITOR 0
+static ScreenSide dockposition = DEFAULT_DOCKPOSITION;
+static int dockmonitor = DEFAULT_DOCKMONITOR;
+static char* dockmonitorname = NULL; /* RandR output name, overrides dockmonitor */
 static char* terminal[2] = { NULL, NULL };
 static char* userscript = NULL;
 static const char* defaultterminal[] = { "kitty", NULL };
@@ -50,6 +54,9 @@ static char selfgcolor[8]; //      = "#eeeeee";
 #define DEFAULT_BORDER_PX 2
 static const unsigned int borderpx  = DEFAULT_BORDER_PX;        /* border pixel of windows */
 static const unsigned int snap      = 32;       /* snap pixel */
+static const unsigned int motionrate = 0;       /* move/resize updates per second, 0 means the screen refresh rate */
+static const Bool outlinemove       = False;    /* True: move/resize floating windows as an outline, configure on release */
+static const char statsfile[]       = "/tmp/dwm-stats.json"; /* written on SIGUSR1 when built with -DSTATS */
 static const unsigned int systraypinning = 0;   /* 0: sloppy systray follows selected monitor, >0: pin systray to monitor X */
 static const unsigned int systrayspacing = 2;   /* systray spacing */
 static const Bool systraypinningfailfirst = True;   /* True: if pinning fails, display systray on the first monitor, False: display systray on the last monitor*/
@@ -62,6 +69,10 @@ static Bool foldtags                = True;
 static Bool showtagshortcuts        = False;
 static const int defaultwindowgap	= 36; /* gap between windows */
 static const int focusmonstart		= 0;
+static const int titlerate          = 10;      /* title repaints per second and monitor, 0 for no limit */
+static const int focusdelay         = 40;      /* ms the pointer rests on a window before it gets the focus, 0 for none */
+static const Bool hidebyunmap       = False;   /* True: unmap clients of hidden tags, so they can stop rendering */
+static const int termpoolsize       = 0;       /* terminals kept started and hidden for spawnterm, 0 for none */
 static const Bool statusallmonitor  = True;
 #define OOFTRAYLEN 5
 static const char* outoffocustraysymbol = "X";
@@ -81,6 +92,11 @@ static const char* outoffocustraysymbol = "X";
 #define SUBTL 0.92
 #define OPAQU 1.0
 
+/* desktop clock */
+static const int clocksize = 200;        /* 0 for none */
+static const Bool clockseconds = False;  /* second hand, repaints every second */
+static const double clockopacity = SPCTR;
+
 static const int layoutaxis[] = {
 	1,    /* layout axis: 1 = x, 2 = y; negative values mirror the layout, setting the master area to the right / bottom instead of left / top */
 	2,    /* master axis: 1 = x (from left to right), 2 = y (from top to bottom), 3 = z (monocle) */
@@ -116,9 +132,22 @@ static const Layout layouts[] = {
 	{ "[M]",      LT(monocle),           0,                 False },
 };
 
+#include "statusmodules.c"
+
+static const Bool usestatusmodules = True;    /* False: show the root window name (xsetroot) instead */
+static const StatusModule statusmodules[] = {
+	/* read function   interval (s)   wall clock */
+	{ statuscpu,       2,             False },
+	{ statusmem,       5,             False },
+	{ statusload,      5,             False },
+	{ statusnet,       2,             False },
+	{ statusbattery,   30,            False },
+	{ statusdate,      60,            True  },
+};
+
 static const Rule defaultrule = 
-	/* class , instance , title , tags mask , float , center, term  , trnsp , nofcs , exfcs , nobdr , rh   , mon , remap , preflt , istrans , isfullscreen , showdock , procname , picomfreeze, next */
-	{   NULL , NULL     , NULL  , anytag    , False , False , False , OPAQU , False , False , False , True , -1  , NULL  , NULL   , False   , False        , -1       , NULL     ,       False, NULL };
+	/* class , instance , title , tags mask , float , center, term  , trnsp , nofcs , exfcs , nobdr , rh   , mon , monname , remap , preflt , istrans , isfullscreen , showdock , procname , picomfreeze, next */
+	{   NULL , NULL     , NULL  , anytag    , False , False , False , OPAQU , False , False , False , True , -1  , NULL    , NULL  , NULL   , False   , False        , -1       , NULL     ,       False, NULL };
 
 static Rule* rules = NULL;
 
@@ -127,11 +156,22 @@ static Key* keys = NULL;
 static Button* buttons = NULL;
 
 #include "remap.c"
+#include "clientsets.c"
+#include "clientpool.c"
+#include "stats.c"
+#include "trace.c"
 #include "viewstack.c"
 #include "push.c"
 #include "rotatemons.c"
 #include "misc.c"
+#include "clock.c"
+#include "status.c"
+#include "hoverfocus.c"
+#include "titles.c"
+#include "termpool.c"
 #include "jsonconfig.c"
+#include "reload.c"
+#include "session.c"
 
 #include <X11/XF86keysym.h>
 
@@ -139,11 +179,7 @@ static Button* buttons = NULL;
 static const KeySym modkeysyms[] = { XK_Super_L, XK_Super_R };
 
 /* commands */
-static const char *clockcmd[] = { "sh", "-c", "picom & oclock", NULL };
+static const char *compositorcmd[] = { "picom", NULL };
 static const char *xrandrcmd[] = { "xrandr", "--output", "DP-5", "--primary", NULL };
-static const char *killclockscmd[] = { "killall", "oclock", NULL };
-static const Rule clockrule =
-	/* class , instance , title , tags mask , float , center, term  , trnsp , nofcs , exfcs , nobdr , rh   , mon , remap , preflt , istrans , isfullscreen , showdock , procname , picomfreeze, next */
-	{  NULL  , "oclock" , NULL  , alltags   , True  , False , False , SPCTR , True  , False , True  , True , -1  , NULL  , NULL   , False   , False        , -1       , NULL     , False,       NULL };
 
 #endif
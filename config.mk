@@ -9,22 +9,38 @@ MANPREFIX = ${PREFIX}/share/man
 
 # includes and libs
 XFTFLAGS = `pkg-config --cflags pangocairo`
-X11FLAGS = `pkg-config --cflags x11-xcb xcb-res xinerama` -DXINERAMA
+X11FLAGS = `pkg-config --cflags x11-xcb xcb-res xinerama xrandr` -DXINERAMA -DXRANDR
 
 XFTLIBS = `pkg-config --libs pangocairo`
-X11LIBS = `pkg-config --libs x11-xcb xcb-res xinerama`
+X11LIBS = `pkg-config --libs x11-xcb xcb-res xinerama xrandr`
 
-LIBS = -lc ${X11LIBS} ${XFTLIBS}
+LIBS = -lc -lm ${X11LIBS} ${XFTLIBS}
 
-SYMBOLSCFLAGS = -g
-SYMBOLSLDFLAGS = -g
-#SYMBOLSCFLAGS =
-#SYMBOLSLDFLAGS = -s
+# make bench, also needs Xvfb
+BENCHLIBS = `pkg-config --cflags --libs xcb xcb-xtest`
+
+# instrumentation, dumped as JSON on SIGUSR1
+#STATSFLAGS = -DSTATS
+
+# build profile: debug, release, pgogen or pgouse
+# (make pgo trains on the bench workload and builds pgouse)
+PROFILE = debug
+PGODIR = `pwd`/pgo
+
+CFLAGS_debug = -g -O0
+LDFLAGS_debug = -g
+CFLAGS_release = -O2 -flto -fno-plt
+LDFLAGS_release = ${CFLAGS_release} -s
+CFLAGS_pgogen = ${CFLAGS_release} -fprofile-generate=${PGODIR}
+LDFLAGS_pgogen = ${CFLAGS_pgogen}
+CFLAGS_pgouse = ${CFLAGS_release} -fprofile-use=${PGODIR} -fprofile-correction -Wno-missing-profile
+LDFLAGS_pgouse = ${CFLAGS_pgouse} -s
 
 # flags
 VERSIONCFLAGS = -DVERSION=\"${VERSION}\"
-CFLAGS = ${SYMBOLSCFLAGS} -std=c99 -pedantic -Wall -O0 -I. -I/usr/include ${XFTFLAGS} ${X11FLAGS} ${VERSIONCFLAGS} -Wno-deprecated-declarations -Wno-parentheses
-LDFLAGS = ${SYMBOLSLDFLAGS} ${LIBS}
+CPPFLAGS = -D_DEFAULT_SOURCE ${VERSIONCFLAGS}
+CFLAGS = ${CFLAGS_${PROFILE}} -std=c99 -pedantic -Wall -I. -I/usr/include ${XFTFLAGS} ${X11FLAGS} ${STATSFLAGS} ${CPPFLAGS} -Wno-deprecated-declarations -Wno-parentheses
+LDFLAGS = ${LDFLAGS_${PROFILE}} ${LIBS}
 
 # compiler and linker
 CC = cc
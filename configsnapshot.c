@@ -0,0 +1,411 @@
+/* Binary config snapshot.
+ *
+ * Once config.json has been parsed, readconfig() writes the result to
+ * config.snap next to it. The snapshot holds Rule, Key and Button records
+ * and strings; pointers in it are offsets from its start, and functions,
+ * layouts and remaps are stored as indices into this build's tables. Later
+ * starts map the snapshot privately and relocate it in place when it was
+ * written from the same config.json (FNV-1a of the content) by a build with
+ * the same tables and defaults, so nothing is parsed or allocated. Any mismatch or bad
+ * offset falls back to parsing. */
+#define SNAPMAGIC   0x70616e73 /* "snap" */
+#define SNAPVERSION 1
+#define SNAPALIGN   8
+#define FNVBASIS    0xcbf29ce484222325ULL
+#define SNAPOFF(o)  ((void *)(uintptr_t)(o))
+
+typedef struct {
+	uint32_t magic, version;
+	uint64_t abi;     /* struct sizes, tables and defaults of the writing build */
+	uint64_t source;  /* hash of config.json */
+	uint64_t size;
+	uint64_t rules, keys, buttons, tags, tagkeys;
+	uint64_t font, terminal, userscript, dockmonitorname;
+	int32_t numtags, dockposition, dockmonitor;
+	uint32_t vtag, tagkeysmod;
+} SnapHeader;
+
+typedef struct {
+	char *data;
+	size_t len, size;
+} SnapBuf;
+
+static char *snapbase = NULL;
+static size_t snapsize = 0;
+static Bool snapok;
+
+static uint64_t
+fnv1a(uint64_t h, const void *data, size_t len) {
+	const unsigned char *p = data;
+
+	while(len--)
+		h = (h ^ *p++) * 0x100000001b3ULL;
+	return h;
+}
+
+static uint64_t
+fnv1astr(uint64_t h, const char *s) {
+	static const unsigned char none = 0xff;  /* never ends a string */
+
+	return s ? fnv1a(h, s, strlen(s) + 1) : fnv1a(h, &none, 1);
+}
+
+static uint64_t
+snapabi(void) {
+	const uint64_t sizes[] = {
+		sizeof(Rule), sizeof(Key), sizeof(Button), sizeof(Arg), sizeof(char *),
+		LENGTH(actions), LENGTH(layouts), LENGTH(remaps), LENGTH(tagkeys),
+	};
+	const Rule *d = &defaultrule;
+	uint64_t h = fnv1a(FNVBASIS, sizes, sizeof sizes);
+	int64_t remap = -1;
+	int i;
+
+	for(i = 0; i < LENGTH(actions); ++i)
+		h = fnv1a(h, actions[i].name, strlen(actions[i].name) + 1);
+	for(i = 0; i < LENGTH(layouts); ++i)
+		h = fnv1a(h, layouts[i].name, strlen(layouts[i].name) + 1);
+	for(i = 0; i < LENGTH(remaps); ++i) {
+		h = fnv1a(h, remaps[i].name, strlen(remaps[i].name) + 1);
+		if(d->remap && remaps[i].remap == d->remap)
+			remap = i;
+	}
+	/* compiled-in defaults the stored config was merged with; the rule goes
+	 * field by field, its padding and pointers mean nothing across builds */
+	const int64_t ints[] = {
+		DEFAULT_VTAG, d->tags, d->isfloating, d->iscenter, d->isterminal, d->nofocus,
+		d->exfocus, d->noborder, d->rh, d->monitor, d->istransient, d->isfullscreen,
+		d->showdock, d->picomfreeze,
+		remap,
+		d->preflayout ? d->preflayout - layouts : -1,
+	};
+	h = fnv1a(h, ints, sizeof ints);
+	h = fnv1a(h, &d->istransparent, sizeof d->istransparent);
+	h = fnv1astr(h, d->class);
+	h = fnv1astr(h, d->instance);
+	h = fnv1astr(h, d->title);
+	h = fnv1astr(h, d->monitorname);
+	h = fnv1astr(h, d->procname);
+	return fnv1astr(h, fallbackfont);
+}
+
+static char *
+snapshotpath(const char *config) {
+	size_t len = strlen(config);
+	char *path;
+
+	if(len > 5 && !strcmp(config + len - 5, ".json"))
+		len -= 5;
+	if(!(path = malloc(len + sizeof(".snap"))))
+		die("fatal: could not malloc() %u bytes\n", len + sizeof(".snap"));
+	memcpy(path, config, len);
+	strcpy(path + len, ".snap");
+	return path;
+}
+
+static uint64_t
+snapput(SnapBuf *b, const void *data, size_t size) {
+	uint64_t off;
+
+	b->len = (b->len + SNAPALIGN - 1) & ~(size_t)(SNAPALIGN - 1);
+	if(b->len + size > b->size) {
+		b->size = MAX(b->size * 2, b->len + size);
+		if(!(b->data = realloc(b->data, b->size)))
+			die("fatal: could not malloc() %u bytes\n", b->size);
+	}
+	off = b->len;
+	if(data)
+		memcpy(b->data + off, data, size);
+	else
+		memset(b->data + off, 0, size);
+	b->len += size;
+	return off;
+}
+
+static uint64_t
+snapputstr(SnapBuf *b, const char *s) {
+	return s ? snapput(b, s, strlen(s) + 1) : 0;
+}
+
+static uintptr_t
+snapremapindex(const Remap *remap) {
+	int i;
+
+	for(i = 0; remap && i < LENGTH(remaps); ++i)
+		if(remaps[i].remap == remap)
+			return i + 1;
+	return 0;
+}
+
+static uintptr_t
+snapfunctionindex(ArgFunction func) {
+	int i;
+
+	for(i = 0; func && i < LENGTH(actions); ++i)
+		if(actions[i].func == func)
+			return i + 1;
+	return 0;
+}
+
+static void
+snapputarg(SnapBuf *b, Arg *arg, ArgFunction func, Bool isbutton) {
+	switch(argkind(func, isbutton)) {
+	case ArgShcmd:
+		arg->shcmd = SNAPOFF(snapputstr(b, arg->shcmd));
+		break;
+	case ArgLayout:
+		arg->v = SNAPOFF(arg->v ? (const Layout *)arg->v - layouts + 1 : 0);
+		break;
+	}
+}
+
+static void
+writesnapshot(const char *path, uint64_t source) {
+	SnapBuf b = { NULL, 0, 0 };
+	SnapHeader h = { SNAPMAGIC, SNAPVERSION, snapabi(), source };
+	char *tmp, *strs[LENGTH(tagkeys) + 1];
+	uint64_t prev, off;
+	const Rule *r;
+	const Key *k;
+	const Button *bt;
+	Rule rule;
+	Key key;
+	Button button;
+	FILE *f;
+	int i;
+
+	snapput(&b, NULL, sizeof h);
+	for(prev = 0, r = rules; r; r = r->next, prev = off) {
+		rule = *r;
+		rule.class = SNAPOFF(snapputstr(&b, r->class));
+		rule.instance = SNAPOFF(snapputstr(&b, r->instance));
+		rule.title = SNAPOFF(snapputstr(&b, r->title));
+		rule.monitorname = SNAPOFF(snapputstr(&b, r->monitorname));
+		rule.procname = SNAPOFF(snapputstr(&b, r->procname));
+		rule.remap = SNAPOFF(snapremapindex(r->remap));
+		rule.preflayout = SNAPOFF(r->preflayout ? r->preflayout - layouts + 1 : 0);
+		rule.next = NULL;
+		off = snapput(&b, &rule, sizeof rule);
+		if(prev)
+			((Rule *)(b.data + prev))->next = SNAPOFF(off);
+		else
+			h.rules = off;
+	}
+	for(prev = 0, k = keys; k; k = k->next, prev = off) {
+		key = *k;
+		snapputarg(&b, &key.arg, k->func, False);
+		key.func = (ArgFunction)snapfunctionindex(k->func);
+		key.next = NULL;
+		key.pending = NULL;
+		off = snapput(&b, &key, sizeof key);
+		if(prev)
+			((Key *)(b.data + prev))->next = SNAPOFF(off);
+		else
+			h.keys = off;
+	}
+	for(prev = 0, bt = buttons; bt; bt = bt->next, prev = off) {
+		button = *bt;
+		snapputarg(&b, &button.arg, bt->func, True);
+		button.func = (ArgFunction)snapfunctionindex(bt->func);
+		button.next = NULL;
+		off = snapput(&b, &button, sizeof button);
+		if(prev)
+			((Button *)(b.data + prev))->next = SNAPOFF(off);
+		else
+			h.buttons = off;
+	}
+	for(i = 0; i <= numtags; ++i)
+		strs[i] = SNAPOFF(i < numtags ? snapputstr(&b, tags[i]) : 0);
+	h.tags = snapput(&b, strs, (numtags + 1) * sizeof(char *));
+	for(i = 0; i < LENGTH(tagkeys); ++i)
+		strs[i] = SNAPOFF(snapputstr(&b, tagkeys[i]));
+	h.tagkeys = snapput(&b, strs, LENGTH(tagkeys) * sizeof(char *));
+	h.font = snapputstr(&b, font);
+	h.terminal = snapputstr(&b, terminal[0]);
+	h.userscript = snapputstr(&b, userscript);
+	h.dockmonitorname = snapputstr(&b, dockmonitorname);
+	h.numtags = numtags;
+	h.vtag = vtag;
+	h.tagkeysmod = tagkeysmod;
+	h.dockposition = dockposition;
+	h.dockmonitor = dockmonitor;
+	h.size = b.len;
+	memcpy(b.data, &h, sizeof h);
+
+	/* write aside and rename, a reader never sees half a snapshot */
+	if(!(tmp = malloc(strlen(path) + sizeof(".tmp"))))
+		die("fatal: could not malloc() %u bytes\n", strlen(path) + sizeof(".tmp"));
+	strcpy(tmp, path);
+	strcat(tmp, ".tmp");
+	if(!(f = fopen(tmp, "wb"))
+	|| fwrite(b.data, 1, b.len, f) != b.len
+	|| fclose(f) || rename(tmp, path))
+		fprintf(stderr, "dwm: cannot write config snapshot %s\n", path);
+	free(tmp);
+	free(b.data);
+}
+
+static void *
+snapat(uintptr_t off, size_t size) {
+	if(!off)
+		return NULL;
+	if(off < sizeof(SnapHeader) || off % SNAPALIGN || off > snapsize || size > snapsize - off) {
+		snapok = False;
+		return NULL;
+	}
+	return snapbase + off;
+}
+
+static char *
+snapstr(uintptr_t off) {
+	char *s = snapat(off, 1);
+
+	if(s && !memchr(s, '\0', snapsize - off)) {
+		snapok = False;
+		return NULL;
+	}
+	return s;
+}
+
+static const void *
+snapindex(uintptr_t i, const void *table, size_t size, size_t len) {
+	if(!i)
+		return NULL;
+	if(i > len) {
+		snapok = False;
+		return NULL;
+	}
+	return (const char *)table + (i - 1) * size;
+}
+
+/* next records always follow their predecessor, which rules out cycles */
+static void *
+snapnext(void *rec, uintptr_t next, size_t size) {
+	if(next && next <= (uintptr_t)((char *)rec - snapbase))
+		snapok = False;
+	return snapok ? snapat(next, size) : NULL;
+}
+
+static void
+snaparg(Arg *arg, ArgFunction func, Bool isbutton) {
+	switch(argkind(func, isbutton)) {
+	case ArgShcmd:
+		arg->shcmd = snapstr((uintptr_t)arg->shcmd);
+		break;
+	case ArgLayout:
+		arg->v = snapindex((uintptr_t)arg->v, layouts, sizeof(Layout), LENGTH(layouts));
+		break;
+	}
+}
+
+static const Remap *
+snapremap(uintptr_t i) {
+	if(i > LENGTH(remaps)) {
+		snapok = False;
+		return NULL;
+	}
+	return i ? remaps[i - 1].remap : NULL;
+}
+
+static ArgFunction
+snapfunction(uintptr_t i) {
+	if(i > LENGTH(actions)) {
+		snapok = False;
+		return NULL;
+	}
+	return i ? actions[i - 1].func : NULL;
+}
+
+static Bool
+loadsnapshot(const char *path, uint64_t source) {
+	SnapHeader *h;
+	Rule *r, *rulelist;
+	Key *k, *keylist;
+	Button *b, *buttonlist;
+	char **tagarray, **tagkeyarray;
+	struct stat st;
+	int fd, i;
+	void *map;
+
+	if((fd = open(path, O_RDONLY)) == -1)
+		return False;
+	if(fstat(fd, &st) || st.st_size < sizeof(SnapHeader)
+	|| (map = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		close(fd);
+		return False;
+	}
+	close(fd);
+	snapbase = map;
+	snapsize = st.st_size;
+	h = map;
+	snapok = h->magic == SNAPMAGIC && h->version == SNAPVERSION && h->abi == snapabi()
+	         && h->source == source && h->size == snapsize
+	         && h->numtags > 0 && h->numtags <= LENGTH(tagkeys);
+	if(!snapok) {
+		munmap(map, snapsize);
+		snapbase = NULL;
+		return False;
+	}
+	rulelist = snapat(h->rules, sizeof(Rule));
+	for(r = rulelist; r && snapok; r = r->next) {
+		r->class = snapstr((uintptr_t)r->class);
+		r->instance = snapstr((uintptr_t)r->instance);
+		r->title = snapstr((uintptr_t)r->title);
+		r->monitorname = snapstr((uintptr_t)r->monitorname);
+		r->procname = snapstr((uintptr_t)r->procname);
+		r->remap = snapremap((uintptr_t)r->remap);
+		r->preflayout = snapindex((uintptr_t)r->preflayout, layouts, sizeof(Layout), LENGTH(layouts));
+		r->next = snapnext(r, (uintptr_t)r->next, sizeof(Rule));
+	}
+	keylist = snapat(h->keys, sizeof(Key));
+	for(k = keylist; k && snapok; k = k->next) {
+		k->func = snapfunction((uintptr_t)k->func);
+		snaparg(&k->arg, k->func, False);
+		k->next = snapnext(k, (uintptr_t)k->next, sizeof(Key));
+	}
+	buttonlist = snapat(h->buttons, sizeof(Button));
+	for(b = buttonlist; b && snapok; b = b->next) {
+		b->func = snapfunction((uintptr_t)b->func);
+		snaparg(&b->arg, b->func, True);
+		b->next = snapnext(b, (uintptr_t)b->next, sizeof(Button));
+	}
+	tagarray = snapat(h->tags, (h->numtags + 1) * sizeof(char *));
+	tagkeyarray = snapat(h->tagkeys, LENGTH(tagkeys) * sizeof(char *));
+	for(i = 0; tagarray && i < h->numtags; ++i)
+		if(!(tagarray[i] = snapstr((uintptr_t)tagarray[i])))
+			snapok = False;
+	if(tagarray)
+		tagarray[h->numtags] = NULL;
+	for(i = 0; tagkeyarray && i < LENGTH(tagkeys); ++i)
+		tagkeyarray[i] = snapstr((uintptr_t)tagkeyarray[i]);
+	if(!snapok || !tagarray || !tagkeyarray) {
+		fprintf(stderr, "dwm: ignoring damaged config snapshot %s\n", path);
+		munmap(map, snapsize);
+		snapbase = NULL;
+		return False;
+	}
+	rules = rulelist;
+	keys = keylist;
+	buttons = buttonlist;
+	tags = tagarray;
+	numtags = h->numtags;
+	vtag = h->vtag;
+	for(i = 0; i < LENGTH(tagkeys); ++i)
+		tagkeys[i] = tagkeyarray[i];
+	tagkeysmod = h->tagkeysmod;
+	font = snapstr(h->font);
+	terminal[0] = snapstr(h->terminal);
+	userscript = snapstr(h->userscript);
+	dockposition = h->dockposition;
+	dockmonitor = h->dockmonitor;
+	dockmonitorname = snapstr(h->dockmonitorname);
+	configstorage = ConfigSnapshot;
+	return True;
+}
+
+static void
+freesnapshot(void) {
+	if(snapbase)
+		munmap(snapbase, snapsize);
+	snapbase = NULL;
+}
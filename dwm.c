@@ -23,12 +23,15 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <locale.h>
+#include <poll.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <X11/cursorfont.h>
@@ -48,6 +51,10 @@
 #ifdef XINERAMA
 #include <X11/extensions/Xinerama.h>
 #endif /* XINERAMA */
+#ifdef XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif /* XRANDR */
+#include "stats.h"
 
 /* macros */
 #define BARSHOWN(m)             (m->by != -bh)
@@ -99,11 +106,13 @@ enum { NetSupported, NetSystemTray, NetSystemTrayOP, NetSystemTrayOrientation, N
 	   NetWMWindowTypeDialog, NetWMWindowTypeDock, NetWMWindowTypeDesktop, NetWMWindowTypeNotification,
 	   NetWMWindowTypeKDEOSD, NetWMWindowTypeKDEOVERRIDE, NetWMStateSkipTaskbar, NetWMDesktop, NetWMOpacity,
 	   NetClientList, NetDesktopNames, NetDesktopViewport, NetDesktopGeometry, NetNumberOfDesktops, 
-	   NetCurrentDesktop, NetLast }; /* EWMH atoms */
+	   NetCurrentDesktop, NetWMBypassCompositor, NetWMHidden, NetLast }; /* EWMH atoms */
 enum { Manager, Xembed, XembedInfo, MotifWMHints, XLast }; /* Xembed atoms */
 enum { WMProtocols, WMDelete, WMState, WMTakeFocus, WMLast };		 /* default atoms */
 enum { ClkTagBar, ClkLtSymbol, ClkStatusText, ClkWinTitle,
 	   ClkClientWin, ClkRootWin, ClkLast };				/* clicks */
+enum { DirtyTitle = 1, DirtyBar = 2, DirtyOpacity = 4, DirtyTags = 8 };	/* deferred monitor work */
+enum { HintUrgency = 1, HintInput = 2, HintIcon = 4 };	/* WM_HINTS changes */
 
 #define CONFIG_HEAD
 #include "config.h"
@@ -137,25 +146,33 @@ typedef struct {
 
 typedef struct Monitor Monitor;
 typedef struct Client Client;
-struct Client {
+typedef struct ClientInfo ClientInfo;
+struct ClientInfo { /* cold data: title, size hints and rule-derived settings */
 	char name[256];
 	float mina, maxa;
-	int x, y, w, h;
-	int oldx, oldy, oldw, oldh;
 	int basew, baseh, incw, inch, maxw, maxh, minw, minh;
-	int bw, oldbw;
-	unsigned int tags;
-	Client *next;
-	Bool isfixed, isfloating, isurgent, neverfocus, oldstate, noborder, nofocus, exfocus, isterminal, isosd, isoverride, picomfreeze, isbackwin;
-	unsigned int isfullscreen;
 	pid_t pid;
+	double opacity;
+	const Remap* remap;
+	Pixmap icon;          /* icon pixmap from WM_HINTS */
+	int unmapsexpected;   /* unmaps dwm did itself to hide the window */
+};
+
+struct Client { /* hot data: everything list walks and layouts touch */
+	Client *next;
 	Client *snext;
 	Monitor *mon;
-	Window win;
-	double opacity;
+	unsigned int tags;
+	int x, y, w, h;
+	int bw;
+	unsigned int isfixed : 1, isfloating : 1, isurgent : 1, neverfocus : 1, oldstate : 1, noborder : 1, nofocus : 1,
+				 exfocus : 1, isterminal : 1, isosd : 1, isoverride : 1, picomfreeze : 1, isbackwin : 1, rh : 1,
+				 ishidden : 1, isshown : 1, isplaced : 1, titlestale : 1;
+	unsigned int isfullscreen;
 	unsigned int actual_opacity;
-	Bool rh;
-	const Remap* remap;
+	Window win;
+	int oldx, oldy, oldw, oldh, oldbw;
+	ClientInfo *info;
 };
 
 typedef struct {
@@ -192,7 +209,7 @@ typedef struct Key {
 	void (*func)(const Arg *);
 	Arg arg;
 	struct Key *next;
-	char* pending;
+	const char* pending;
 } Key;
 
 typedef struct {
@@ -219,6 +236,7 @@ struct ViewStack {
 
 struct Monitor {
 	char ltsymbol[16];
+	char outputname[32];  /* RandR output, empty without RandR 1.5 */
 	int num;
 	int by;				  /* bar geometry */
 	int mx, my, mw, mh;   /* screen size */
@@ -233,8 +251,21 @@ struct Monitor {
 	Window clock;
 	ViewStack *vs;
 	Window backwin;
+	Bool reconfigured;    /* geometry or clients changed in last updategeom() */
+	int statusx;          /* where drawbar() put the status segments, -1 if clipped */
+	Window fullscreenwin; /* fullscreen client covering the monitor, its bar and clock are left alone */
+	int tagsw;            /* width of the tag segment of the last drawbar() */
+	int titlex, titlew;   /* title segment of the last drawbar() */
+	unsigned int dirty;   /* Dirty* work left for flushdirty() */
+	long long titledrawn; /* ms, last title repaint scheduled by titles.c */
+	Bool titlewaiting;    /* a title change waits for the rate limit */
 };
 
+typedef struct {
+	int x, y, w, h;
+	char name[32];
+} ScreenGeom;
+
 
 typedef struct Rule Rule;
 struct Rule {
@@ -251,6 +282,7 @@ struct Rule {
 	Bool noborder;
 	Bool rh;
 	int monitor;
+	char* monitorname;
 	const Remap* remap;
 	const Layout* preflayout;
 	Bool istransient;
@@ -278,6 +310,10 @@ typedef struct Systray   Systray;
 struct Systray {
 	Window win;
 	Client *icons;
+	int x, y, w;          /* geometry last given to win */
+	unsigned long bg;     /* background last given to win */
+	unsigned int width;   /* what getsystraywidth() returns */
+	Bool widthstale;      /* an icon came, went or changed size */
 };
 
 /* function declarations */
@@ -292,7 +328,11 @@ static void attachend(Client *c);
 static void attachstack(Client *c);
 static void buttonpress(XEvent *e);
 static void buttonrelease(XEvent *e);
+static void cancelhover(void);
+static void checkconfigtimes(void);
 static void checkotherwm(void);
+static const char *clienttitle(Client *c);
+static Bool claimpoolterm(void);
 static void cleanup(void);
 static void cleanupmon(Monitor *mon);
 static void cleartags(Monitor *m);
@@ -302,20 +342,34 @@ static void configure(Client *c);
 static void configurenotify(XEvent *e);
 static void configurerequest(XEvent *e);
 static unsigned int counttiledclients (Monitor* m);
+static Monitor *clocktomon(Window w);
+static void createclock(Monitor *m);
 static void createclocks(void);
 static Bool clientmatchesrule (Client *c, const char* class, const char* instance, Bool istransient, const char* wincmdline, const Rule *r);
 static Monitor *createmon(void);
+static void delayhover(Window w);
+static void destroyclock(Monitor *m);
 static void destroynotify(XEvent *e);
+static void droppoolterm(Window w);
 static void detach(Client *c);
 static void detachstack(Client *c);
 static void die(const char *errstr, ...);
 static Monitor *dirtomon(int dir);
+static Monitor *dockmon(void);
 static void drawbar(Monitor *m);
 static void drawbars(void);
+static void drawclock(Monitor *m);
+static void drawclocks(void);
+static void drawstatus(void);
 static void drawsquare(Bool filled, Bool empty, Bool invert, unsigned long col[ColLast]);
+static void drawtags(Monitor *m);
 static void drawtext(const char *text, unsigned long col[ColLast], Bool invert, Bool centre);
+static void drawtitle(Monitor *m);
 static void enternotify(XEvent *e);
+static Bool flushdirty(void);
+static void hover(Window w);
 static void expose(XEvent *e);
+static Monitor *findmon(int num, const char *name);
 static void focus(Client *c);
 static void focusin(XEvent *e);
 static void focusmon(const Arg *arg);
@@ -343,17 +397,26 @@ static void killclocks(void);
 static void maketagtext(char* text, int maxlength, int i);
 static void manage(Window w, XWindowAttributes *wa);
 static void mappingnotify(XEvent *e);
+static void markdirty(Monitor *m, unsigned int what);
 static void maprequest(XEvent *e);
 static unsigned int intersecttags(Client *c, Monitor *m);
 static void monocle(Monitor *m);
 static void motionnotify(XEvent *e);
+static void moveclock(Monitor *m);
 static void movemouse(const Arg *arg);
+static GC createoutlinegc(void);
+static unsigned int getmotioninterval(void);
 static Client *nexttiled(Client *c);
 static void pop(Client *c);
 static void push(Client *c);
+static Bool pooltermwindow(Window w);
 static void propertynotify(XEvent *e);
 static void quit(const Arg *arg);
+#ifdef XRANDR
+static void randrnotify(XEvent *e);
+#endif /* XRANDR */
 static Monitor *recttomon(int x, int y, int w, int h);
+static void reloadconfig(const Arg *arg);
 static void removesystrayicon(Client *i);
 static void resetprimarymonitor();
 static void resize(Client *c, int x, int y, int w, int h, Bool interact);
@@ -363,6 +426,9 @@ static void resizeclient(Client *c, int x, int y, int w, int h);
 static void resizemouse(const Arg *arg);
 static void resizerequest(XEvent *e);
 static void restack(Monitor *m);
+static void restackpair(Client *c, Client *old);
+static void redrawtags(Monitor *m);
+static void restart(const Arg *arg);
 static void restackwindows();
 static void restorebar(Monitor *m);
 static void run(void);
@@ -371,6 +437,7 @@ static Bool sendevent(Window w, Atom proto, int m, long d0, long d1, long d2, lo
 static void sendmon(Client *c, Monitor *m);
 static void selectmon(Monitor* m);
 static void setclientstate(Client *c, long state);
+static void setnetwmstate(Client *c);
 static void setdesktopnames(void);
 static void setclientopacity(Client *c);
 static void setfocus(Client *c);
@@ -391,13 +458,29 @@ static void spawn(const Arg *arg);
 static void systrayaddwindow (Window win);
 static void spawnimpl(const Arg *arg, Bool waitdeath, Bool useshcmd);
 static void spawnterm(const Arg *arg);
+static pid_t forkterm(void);
+static void startreload(void);
+static void startstatus(void);
+static void starttermpool(void);
+static int statuswidth(void);
+static void stophover(void);
+static void stoptermpool(void);
+static void stoptitles(void);
+static void stopstatus(void);
 static Monitor *systraytomon(Monitor *m);
 static void swap(Client *c1, Client *c2);
+static void swapconfig(void);
 static void tabview(const Arg *arg);
 static void tag(const Arg *arg);
 static void tagmon(const Arg *arg);
 static long tagsettonum (unsigned int tagset);
 static int textnw(const char *text, unsigned int len);
+static void tickclocks(void);
+static void tickhover(void);
+static void tickreload(void);
+static void ticktitles(void);
+static void titlechanged(Client *c);
+static void tickstatus(int i);
 static void tile(Monitor *);
 static void togglebar(const Arg *arg);
 static void toggledock(const Arg *arg);
@@ -414,20 +497,22 @@ static void updateclientdesktop(Client *c);
 static void updatecurrentdesktop(void);
 static void updateborderswidth(Monitor *m);
 static void updatecolors(const Arg *arg);
-static void updategeom(void);
+static Bool updategeom(void);
 static void updatebarpos(Monitor *m);
 static void updatebars(void);
 static void updateclientlist(void);
 static void updatedockpos(Monitor *m);
 static void updatenumlockmask(void);
+static void updatefullscreenmode(Monitor *m);
 static void updatesizehints(Client *c);
+static void updatescreen(int width, int height);
 static void updatestatus(void);
 static void updatesystray(void);
 static void updatesystrayicongeom(Client *i, int w, int h);
 static void updatesystrayiconstate(Client *i, XPropertyEvent *ev);
 static void updatewindowtype(Client *c);
 static void updatetitle(Client *c);
-static void updatewmhints(Client *c);
+static unsigned int updatewmhints(Client *c);
 static void view(const Arg *arg);
 static void monview(Monitor* m, unsigned int ui);
 static void monshowbar(Monitor* m, Bool show);
@@ -484,8 +569,15 @@ static xcb_connection_t *xcon;
 static Client* lastclient = NULL;
 static Bool startup = True;
 static Bool rotatingMons = False;
+static Bool restackdirty = False;
+static Monitor *lastfocusmon = NULL;
+static unsigned int lastfocustags = 0;
 static unsigned int statuscommutator = 0;
 static const Rule *lastruleapplied = NULL;
+#ifdef XRANDR
+static int rrevbase = 0;
+static Bool randrmonitors = False; /* RandR >= 1.5, monitors known by output name */
+#endif /* XRANDR */
 
 /* configuration, allows nested code to access above variables */
 #include "config.h"
@@ -510,7 +602,7 @@ Window getWindowParent (Window winId) {
 
 Bool
 clientmatchesrule (Client *c, const char* class, const char* instance, Bool istransient, const char* wincmdline, const Rule *r) {
-	return (!r->title || strstr(c->name, r->title))
+	return (!r->title || strstr(clienttitle(c), r->title))
 		&& (!r->class || strstr(class, r->class))
 		&& (!r->instance || strstr(instance, r->instance))
 		&& (!r->procname || wincmdline && strstr(wincmdline, r->procname))
@@ -522,7 +614,7 @@ applyclientrule (Client *c, const Rule *r, Bool istransient) {
 	Monitor *m;
 
 	c->isfloating = r->isfloating;
-	c->isterminal = r->isterminal;
+	c->isterminal = (r->isterminal != 0);
 	if (r->nofocus)
 		c->nofocus = True;
 	else if (r->exfocus)
@@ -533,10 +625,10 @@ applyclientrule (Client *c, const Rule *r, Bool istransient) {
 		c->picomfreeze = True;
 	c->tags |= r->tags;
 	if (r->istransient != 1.)
-		c->opacity = r->istransparent;
+		c->info->opacity = r->istransparent;
 	c->rh = r->rh;
 	if (r->remap != NULL)
-		c->remap = r->remap;
+		c->info->remap = r->remap;
 	if (istransient)
 		c->isfixed = True;
 	if (r->isfullscreen)
@@ -545,8 +637,7 @@ applyclientrule (Client *c, const Rule *r, Bool istransient) {
         c->x = (c->mon->ww - c->w) / 2;
         c->y = (c->mon->wh - c->h) / 2;
     }
-	for(m = mons; m && m->num != r->monitor; m = m->next);
-	if(m)
+	if((m = findmon(r->monitor, r->monitorname)))
 		c->mon = m;
 }
 
@@ -599,6 +690,8 @@ applyrules(Client *c) {
 	unsigned int currenttagset = c->mon->vs->tagset;
 	unsigned int nc = 0;
 
+	if(restoreclient(c))
+		return;
 	lastruleapplied = NULL;
 	/* rule matching */
 	c->isfloating = c->tags = 0;
@@ -622,14 +715,6 @@ applyrules(Client *c) {
 			}
 			++i;
 		}
-		if (clientmatchesrule(c, class, instance, istransient, wincmdline, &clockrule)) {
-			applyclientrule(c, &clockrule, istransient);
-			for(m = mons; m && m->clock; m = m->next);
-			if (m) {
-				m->clock = c->win;
-				c->mon = m;
-			}
-		}
 		if(ch.res_class)
 			XFree(ch.res_class);
 		if(ch.res_name)
@@ -641,10 +726,9 @@ applyrules(Client *c) {
 	{
 		i = 0;
 		for (r = rules; r; r = r->next) {
-			if(r->title && strstr(c->name, r->title)) {
+			if(r->title && strstr(clienttitle(c), r->title)) {
 				applyclientrule(c, r, False);
-				for(m = mons; m && m->num != r->monitor; m = m->next);
-				if(m)
+				if((m = findmon(r->monitor, r->monitorname)))
 					c->mon = m;
 				found = True;
 				lastruleapplied = r;
@@ -654,12 +738,12 @@ applyrules(Client *c) {
 		if(!found) {
 			r = &defaultrule;
 			applyclientrule(c, r, False);
-			for(m = mons; m && m->num != r->monitor; m = m->next);
-			if(m)
+			if((m = findmon(r->monitor, r->monitorname)))
 				c->mon = m;
 		}
 	}
 	c->tags = c->tags & TAGMASK ? c->tags & TAGMASK : c->mon->vs->tagset;
+	trackclient(c);
 	if (c->mon) {
 		if (!startup) {
 			if (intersecttags(c, c->mon) != 0 && !c->nofocus && c->tags != TAGMASK) {
@@ -736,34 +820,34 @@ applysizehints(Client *c, int *x, int *y, int *w, int *h, Bool interact) {
 		*w = bh;
 	if(c->rh || c->isfloating || !c->mon->vs->lt[c->mon->vs->curlt]->arrange) {
 		/* see last two sentences in ICCCM 4.1.2.3 */
-		baseismin = c->basew == c->minw && c->baseh == c->minh;
+		baseismin = c->info->basew == c->info->minw && c->info->baseh == c->info->minh;
 		if(!baseismin) { /* temporarily remove base dimensions */
-			*w -= c->basew;
-			*h -= c->baseh;
+			*w -= c->info->basew;
+			*h -= c->info->baseh;
 		}
 		/* adjust for aspect limits */
-		if(c->mina > 0 && c->maxa > 0) {
-			if(c->maxa < (float)*w / *h)
-				*w = *h * c->maxa + 0.5;
-			else if(c->mina < (float)*h / *w)
-				*h = *w * c->mina + 0.5;
+		if(c->info->mina > 0 && c->info->maxa > 0) {
+			if(c->info->maxa < (float)*w / *h)
+				*w = *h * c->info->maxa + 0.5;
+			else if(c->info->mina < (float)*h / *w)
+				*h = *w * c->info->mina + 0.5;
 		}
 		if(baseismin) { /* increment calculation requires this */
-			*w -= c->basew;
-			*h -= c->baseh;
+			*w -= c->info->basew;
+			*h -= c->info->baseh;
 		}
 		/* adjust for increment value */
-		if(c->incw)
-			*w -= *w % c->incw;
-		if(c->inch)
-			*h -= *h % c->inch;
+		if(c->info->incw)
+			*w -= *w % c->info->incw;
+		if(c->info->inch)
+			*h -= *h % c->info->inch;
 		/* restore base dimensions */
-		*w = MAX(*w + c->basew, c->minw);
-		*h = MAX(*h + c->baseh, c->minh);
-		if(c->maxw)
-			*w = MIN(*w, c->maxw);
-		if(c->maxh)
-			*h = MIN(*h, c->maxh);
+		*w = MAX(*w + c->info->basew, c->info->minw);
+		*h = MAX(*h + c->info->baseh, c->info->minh);
+		if(c->info->maxw)
+			*w = MIN(*w, c->info->maxw);
+		if(c->info->maxh)
+			*h = MIN(*h, c->info->maxh);
 		if (!c->isfloating && m->vs->lt[m->vs->curlt]->arrange)
 		{
 			n = 0;
@@ -784,6 +868,7 @@ applysizehints(Client *c, int *x, int *y, int *w, int *h, Bool interact) {
 
 void
 arrange(Monitor *m) {
+	STATS_COUNT(arranges);
 	if(m)
 		showhide(m->stack);
 	else for(m = mons; m; m = m->next)
@@ -796,6 +881,10 @@ arrange(Monitor *m) {
 		updateopacities(m);
 	else for(m = mons; m; m = m->next)
 		updateopacities(m);
+	if (m)
+		updatefullscreenmode(m);
+	else for(m = mons; m; m = m->next)
+		updatefullscreenmode(m);
 }
 
 void
@@ -813,6 +902,7 @@ arrangemon(Monitor *m) {
 
 void
 attach(Client *c) {
+	c->isplaced = False; /* may come from another monitor, showhide() places it again */
 	c->next = c->mon->clients;
 	c->mon->clients = c;
 }
@@ -883,7 +973,7 @@ buttonpress(XEvent *e) {
 		}
 		else if(ev->x < x + blw)
 			click = ClkLtSymbol;
-		else if(ev->x > selmon->ww - TEXTW(stext) - getsystraywidth())
+		else if(ev->x > selmon->ww - statuswidth() - getsystraywidth())
 			click = ClkStatusText;
 		else
 			click = ClkWinTitle;
@@ -894,13 +984,13 @@ buttonpress(XEvent *e) {
         sendevent = True;
 		cfocus = c;
 	}
-	if(cfocus && cfocus->remap)
-		for(i = 0; cfocus->remap[i].keysymto; i++)
-			if(click == cfocus->remap[i].click
-					&& cfocus->remap[i].mousebuttonfrom
-					&& cfocus->remap[i].mousebuttonfrom == ev->button) {
+	if(cfocus && cfocus->info->remap)
+		for(i = 0; cfocus->info->remap[i].keysymto; i++)
+			if(click == cfocus->info->remap[i].click
+					&& cfocus->info->remap[i].mousebuttonfrom
+					&& cfocus->info->remap[i].mousebuttonfrom == ev->button) {
 				remapped = True;
-				sendKey(XKeysymToKeycode(dpy, cfocus->remap[i].keysymto), cfocus->remap[i].modifier);
+				sendKey(XKeysymToKeycode(dpy, cfocus->info->remap[i].keysymto), cfocus->info->remap[i].modifier);
 			}
 	if(!remapped) {
 		while(button) {
@@ -927,11 +1017,11 @@ buttonrelease(XEvent *e) {
 		sendevent = True;
 		cfocus = c;
 	}
-	if(cfocus && cfocus->remap)
-		for(i = 0; cfocus->remap[i].keysymto; i++)
-			if(click == cfocus->remap[i].click
-					&& cfocus->remap[i].mousebuttonfrom
-					&& cfocus->remap[i].mousebuttonfrom == ev->button)
+	if(cfocus && cfocus->info->remap)
+		for(i = 0; cfocus->info->remap[i].keysymto; i++)
+			if(click == cfocus->info->remap[i].click
+					&& cfocus->info->remap[i].mousebuttonfrom
+					&& cfocus->info->remap[i].mousebuttonfrom == ev->button)
 				sendevent = False;
 	if(sendevent)
 		XSendEvent(dpy, c->win, False, ButtonReleaseMask, e);
@@ -947,84 +1037,11 @@ checkotherwm(void) {
 	XSync(dpy, False);
 }
 
-void
-cleanrule (Rule *rule) {
-	free(rule->class);
-	free(rule->instance);
-	free(rule->title);
-	free(rule->procname);
-	free(rule);
-}
-
-void
-cleanrules(void) {
-	Rule *r;
-
-	while (rules) {
-		r = rules;
-		rules = r->next;
-		cleanrule(r);
-	}
-}
-
-void
-cleankey(Key* key) {
-	if(key->func == &spawn)
-		free(key->arg.shcmd);
-	free(key);
-}
-
-void
-cleankeys(void) {
-	Key *k;
-
-	while (keys) {
-		k = keys;
-		keys = k->next;
-		cleankey(k);
-	}
-}
-
-void
-cleanbutton(Button *button) {
-	if(button->func == &spawn)
-		free(button->arg.shcmd);
-	free(button);
-}
-
-void
-cleanbuttons(void) {
-	Button *b;
-
-	while(buttons) {
-		b = buttons;
-		buttons = b->next;
-		cleanbutton(b);
-	}
-}
-
-void
-cleantags(void) {
-	int i;
-
-	for (i = 0; tags[i]; ++i)
-		free(tags[i]);
-	free(tags);
-}
-
 void
 cleanupconfig() {
-	int i;
-
-	cleanrules();
-	cleankeys();
-	cleanbuttons();
-	cleantags();
-	free(font);
-	free(terminal[0]);
-	for(i = 0; i < LENGTH(tagkeys); ++i)
-		if(tagkeys[i])
-			free(tagkeys[i]);
+	if(configstorage == ConfigSnapshot)
+		freesnapshot();
+	freearena(&configarena);
 }
 
 void
@@ -1032,9 +1049,20 @@ cleanup(void) {
 	Arg a = {.ui = ~0};
 	Layout foo = { "", NULL };
 	Monitor *m;
+	Client *c;
 
 	view(&a);
 	selmon->vs->lt[selmon->vs->curlt] = &foo;
+	/* unmap-hidden clients of other monitors would be withdrawn while
+	 * unmapped, out of reach of the next window manager and of scan() */
+	for(m = mons; m; m = m->next)
+		for(c = m->clients; c; c = c->next)
+			if(c->ishidden) {
+				c->ishidden = False;
+				setnetwmstate(c);
+				XMoveWindow(dpy, c->win, WIDTH(c) * -2, c->y);
+				XMapWindow(dpy, c->win);
+			}
 	for(m = mons; m; m = m->next)
 		while(m->stack)
 			unmanage(m->stack, False);
@@ -1044,6 +1072,11 @@ cleanup(void) {
 	XFreeCursor(dpy, cursor[CurNormal]);
 	XFreeCursor(dpy, cursor[CurResize]);
 	XFreeCursor(dpy, cursor[CurMove]);
+	killclocks();
+	stopstatus();
+	stophover();
+	stoptitles();
+	stoptermpool();
 	while(mons)
 		cleanupmon(mons);
 	if(showsystray) {
@@ -1052,6 +1085,9 @@ cleanup(void) {
 		free(systray);
 	}
 	cleanupconfig();
+	cleanupclientpool();
+	cleanupclientsets();
+	stoprecording();
 	XSync(dpy, False);
 	XSetInputFocus(dpy, PointerRoot, RevertToPointerRoot, CurrentTime);
 }
@@ -1068,7 +1104,10 @@ cleanupmon(Monitor *mon) {
 	}
 	XUnmapWindow(dpy, mon->barwin);
 	XDestroyWindow(dpy, mon->barwin);
+	destroyclock(mon);
 	cleanupviewstack(mon->vs);
+	if(lastfocusmon == mon)
+		lastfocusmon = NULL;
 	free(mon);
 }
 
@@ -1162,13 +1201,21 @@ configure(Client *c) {
 
 void
 configurenotify(XEvent *e) {
+	XConfigureEvent *ev = &e->xconfigure;
+
+	if(ev->window == root)
+		updatescreen(ev->width, ev->height);
+}
+
+void
+updatescreen(int width, int height) {
 	Client *c;
 	Monitor *m;
-	XConfigureEvent *ev = &e->xconfigure;
+	Bool resized = (sw != width || sh != height);
 
-	if(ev->window == root) {
-		sw = ev->width;
-		sh = ev->height;
+	sw = width;
+	sh = height;
+	if(resized) {
 		if(dc.cairo.surface != NULL) {
 			cairo_destroy(dc.cairo.context);
 			cairo_surface_destroy(dc.cairo.surface);
@@ -1178,20 +1225,26 @@ configurenotify(XEvent *e) {
 		dc.drawable = XCreatePixmap(dpy, root, sw, bh, DefaultDepth(dpy, screen));
 		dc.cairo.surface = cairo_xlib_surface_create(dpy, dc.drawable, DefaultVisual(dpy, screen), DisplayWidth(dpy, screen), bh);
 		dc.cairo.context = cairo_create(dc.cairo.surface);
-		updategeom();
-		updatebars();
-		for(m = mons; m; m = m->next) {
-			for(c = m->clients; c; c = c->next)
-				if(c->isfullscreen)
-					resizeclient(c, m->mx, m->my, m->mw, m->mh);
-			resizebarwin(m);
+	}
+	if(!updategeom() && !resized)
+		return;
+	updatebars();
+	for(m = mons; m; m = m->next) {
+		if(!m->reconfigured)
+			continue;
+		for(c = m->clients; c; c = c->next) {
+			c->isplaced = False;
+			if(c->isfullscreen)
+				resizeclient(c, m->mx, m->my, m->mw, m->mh);
 		}
-		focus(NULL);
-		arrange(NULL);
-		restackwindows();
-		killclocks();
-		createclocks();
+		resizebarwin(m);
+		moveclock(m);
 	}
+	focus(NULL);
+	for(m = mons; m; m = m->next)
+		if(m->reconfigured)
+			arrange(m);
+	restackwindows();
 }
 
 void
@@ -1276,6 +1329,7 @@ createmon(void) {
 		die("fatal: could not malloc() %u bytes\n", sizeof(Monitor));
 	m->vs = createviewstack(NULL, 1);
 	m->topbar = topbar;
+	m->statusx = -1;
 	strncpy(m->ltsymbol, layouts[0].symbol, sizeof m->ltsymbol);
 
 	return m;
@@ -1295,6 +1349,8 @@ destroynotify(XEvent *e) {
 		resizebarwin(selmon);
 		updatesystray();
 	}
+	else
+		droppoolterm(ev->window);
 }
 
 void
@@ -1328,6 +1384,16 @@ die(const char *errstr, ...) {
 	exit(EXIT_FAILURE);
 }
 
+Monitor *
+findmon(int num, const char *name) {
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		if(name ? !strcmp(m->outputname, name) : m->num == num)
+			return m;
+	return NULL;
+}
+
 Monitor *
 dirtomon(int dir) {
 	Monitor *m = NULL;
@@ -1343,19 +1409,20 @@ dirtomon(int dir) {
 	return m;
 }
 
+Monitor *
+dockmon(void) {
+	return findmon(dockmonitor, dockmonitorname);
+}
+
+/* draws the tag segment from x = 0, leaves dc.x at its end */
 void
-drawbar(Monitor *m) {
-	int x;
+drawtags(Monitor *m) {
 	unsigned int i, occ = 0, urg = 0;
 	unsigned long *col;
 	Client *c;
 	Bool hasfullscreenv = False;
 	char text[32];
 
-	resizebarwin(m);
-	if(showsystray && m == systraytomon(m)) {
-		m->wwo -= getsystraywidth();
-	}
 	for(c = m->clients; c; c = c->next) {
 		if(c->tags != TAGMASK && !c->nofocus && c->tags != TAGMASK)
 			occ |= c->tags;
@@ -1384,6 +1451,36 @@ drawbar(Monitor *m) {
 			dc.x += dc.w;
 		}
 	}
+	m->tagsw = dc.x;
+}
+
+/* repaints only the tag segment, the whole bar if its width changed */
+void
+redrawtags(Monitor *m) {
+	int w = m->tagsw;
+
+	if(m->fullscreenwin)
+		return;
+	drawtags(m);
+	if(m->tagsw != w)
+		drawbar(m);
+	else
+		XCopyArea(dpy, dc.drawable, m->barwin, dc.gc, 0, 0, w, bh, 0, 0);
+}
+
+void
+drawbar(Monitor *m) {
+	int x;
+	unsigned long *col;
+
+	if(m->fullscreenwin)
+		return;
+	STATS_COUNT(drawbars);
+	resizebarwin(m);
+	if(showsystray && m == systraytomon(m)) {
+		m->wwo -= getsystraywidth();
+	}
+	drawtags(m);
 	dc.w = blw = TEXTW(m->ltsymbol);
 	drawtext(m->ltsymbol, dc.norm, False, False);
 	dc.x += dc.w;
@@ -1394,21 +1491,29 @@ drawbar(Monitor *m) {
 			dc.w = (int)getsystraywidth();
 			drawtext(ooftraysbl, dc.norm, False, False);
 		}
-		dc.w = TEXTW(stext);
-		dc.x = m->wwo - dc.w - (m == selmon ? 0 : getsystraywidth());
+		dc.w = statuswidth();
+		dc.x = m->statusx = m->wwo - dc.w - (m == selmon ? 0 : getsystraywidth());
 		if(dc.x < x) {
 			dc.x = x;
 			dc.w = m->wwo - x;
+			m->statusx = -1;
 		}
-		drawtext(stext, dc.norm, False, False);
+		if(usestatusmodules && m->statusx >= 0)
+			drawstatus();
+		else
+			drawtext(usestatusmodules ? NULL : stext, dc.norm, False, False);
 	}
-	else
+	else {
 		dc.x = m->wwo;
+		m->statusx = -1;
+	}
+	m->titlex = x;
+	m->titlew = dc.x - x;
 	if((dc.w = dc.x - x) > bh) {
 		dc.x = x;
 		col = m == selmon ? dc.sel : dc.norm;
 		if(m->sel) {
-			drawtext(m->sel->name, col, False, centretitle);
+			drawtext(clienttitle(m->sel), col, False, centretitle);
 			drawsquare(m->sel->isfixed, m->sel->isfloating, False, col);
 		}
 		else {
@@ -1422,6 +1527,24 @@ drawbar(Monitor *m) {
 	XSync(dpy, False);
 }
 
+/* repaints only the title segment, as placed by the last drawbar() */
+void
+drawtitle(Monitor *m) {
+	unsigned long *col = m == selmon ? dc.sel : dc.norm;
+
+	if(m->fullscreenwin || m->titlew <= bh)
+		return;
+	dc.x = m->titlex;
+	dc.w = m->titlew;
+	if(m->sel) {
+		drawtext(clienttitle(m->sel), col, False, centretitle);
+		drawsquare(m->sel->isfixed, m->sel->isfloating, False, col);
+	}
+	else
+		drawtext(NULL, col, False, False);
+	XCopyArea(dpy, dc.drawable, m->barwin, dc.gc, m->titlex, 0, m->titlew, bh, m->titlex, 0);
+}
+
 void
 drawbars(void) {
 	Monitor *m;
@@ -1478,6 +1601,7 @@ drawtext(const char *text, unsigned long col[ColLast], Bool invert, Bool centre)
 		return;
 	if(len < olen)
 		for (i = len; i && i > len - MIN(olen - len, 3); buf[--i] = '.');
+	STATS_PANGO_BEGIN();
 	pango_layout_set_text(dc.cairo.layout, buf, len);
 	pango_layout_get_extents(dc.cairo.layout, 0, &pr);
 	if(centre) {
@@ -1495,20 +1619,33 @@ drawtext(const char *text, unsigned long col[ColLast], Bool invert, Bool centre)
 			 1.);
 	cairo_move_to(dc.cairo.context, x, y);
 	pango_cairo_show_layout(dc.cairo.context, dc.cairo.layout);
+	STATS_PANGO_END();
 }
 
 void
 enternotify(XEvent *e) {
-	Client *c;
-	Monitor *m;
 	XCrossingEvent *ev = &e->xcrossing;
 
 	if((ev->mode != NotifyNormal || ev->detail == NotifyInferior) && ev->window != root)
 		return;
-	c = wintoclient(ev->window);
+	if(focusdelay > 0)
+		delayhover(ev->window);
+	else
+		hover(ev->window);
+}
+
+void
+hover(Window w) {
+	Client *c;
+	Monitor *m;
+
+	c = wintoclient(w);
 	if(c && c->actual_opacity == 0)
 		return;
-	if((m = wintomon(ev->window)) && m != selmon && ev->window != root) {
+	m = wintomon(w);
+	if(m && m->fullscreenwin && w != m->fullscreenwin)
+		return;
+	if(m && m != selmon && w != root) {
 		unfocus(selmon->sel, True);
 		selectmon(m);
 	}
@@ -1522,7 +1659,9 @@ expose(XEvent *e) {
 	Monitor *m;
 	XExposeEvent *ev = &e->xexpose;
 
-	if(ev->count == 0 && (m = wintomon(ev->window))) {
+	if(ev->count == 0 && (m = clocktomon(ev->window)))
+		drawclock(m);
+	else if(ev->count == 0 && (m = wintomon(ev->window))) {
 		drawbar(m);
 		if(m == selmon)
 			updatesystray();
@@ -1537,28 +1676,29 @@ window_opacity_set(Window win, unsigned int opacitybyte) {
 
 void
 setclientopacity(Client *c) {
-	c->actual_opacity = OPACITY_BYTES(c->opacity);
+	c->actual_opacity = OPACITY_BYTES(c->info->opacity);
 	window_opacity_set(c->win, c->actual_opacity);
 }
 
 void
 focus(Client *c) {
 	Client *inc = c;
-	Client *oc;
-	Monitor *m;
+	Client *old, *ex;
+	Bool urgent = False;
 
-	for(m = mons; m; m = m->next)
-		for(oc = m->clients; oc; oc = oc->next)
-			if (oc->exfocus && ISVISIBLE(oc))
-				c = oc;
+	cancelhover();
+	if((ex = exfocusclient()))
+		c = ex;
 	if(!c || !ISVISIBLE(c))
 		for(c = selmon->stack; c && (!ISVISIBLE(c) || c->tags == TAGMASK); c = c->snext);
 	/* was if(selmon->sel) */
 	if(selmon->sel && selmon->sel != c)
 		unfocus(selmon->sel, False);
 	if(c) {
-		if(c->isurgent)
+		if(c->isurgent) {
 			clearurgent(c);
+			urgent = True;
+		}
 		if(!ISFLOATING(c)) {
 			detachstack(c);
 			attachstack(c);
@@ -1568,22 +1708,76 @@ focus(Client *c) {
 		c = c->next;
 	if (c && (!ISVISIBLE(c) || c->nofocus))
 		c = NULL;
+	/* the focus itself changes now, stacking, opacities and bars are left
+	 * to flushdirty() once the event queue is drained */
 	if (c) {
 		grabbuttons(c, True);
 		XSetWindowBorder(dpy, c->win, dc.sel[ColBorder]);
 		setfocus(c);
+		old = c->mon->sel;
 		c->mon->sel = c;
-		restack(c->mon);
-		updateopacities(c->mon);
+		if(old && old != c && !restackdirty)
+			restackpair(c, old);
+		else if(old != c)
+			restackdirty = True;
+		markdirty(c->mon, DirtyOpacity);
 	}
 	else {
 		XSetInputFocus(dpy, root, RevertToPointerRoot, CurrentTime);
 		XDeleteProperty(dpy, root, netatom[NetActiveWindow]);
-		if(selmon)
-			restack(selmon);
+		restackdirty = True;
 	}
-	drawbars();
-	XSync(dpy, False);
+	/* the tag bar marks the tags of the focused client */
+	if(selmon == lastfocusmon && (!c || c->mon == selmon)
+	&& (c ? c->tags : 0) == lastfocustags && !urgent)
+		markdirty(selmon, DirtyTitle);
+	else
+		markdirty(NULL, DirtyBar);
+	lastfocusmon = selmon;
+	lastfocustags = c ? c->tags : 0;
+}
+
+void
+markdirty(Monitor *m, unsigned int what) {
+	if(m)
+		m->dirty |= what;
+	else for(m = mons; m; m = m->next)
+		m->dirty |= what;
+}
+
+/* does the work focus() deferred, returns whether there was any */
+Bool
+flushdirty(void) {
+	Monitor *m;
+	Bool bars = False, done = restackdirty;
+
+	if(restackdirty) {
+		restackdirty = False;
+		restackwindows();
+	}
+	for(m = mons; m; m = m->next) {
+		if(!m->dirty)
+			continue;
+		done = True;
+		if(m->dirty & DirtyOpacity)
+			updateopacities(m);
+		if(m->dirty & DirtyBar) {
+			drawbar(m);
+			bars = True;
+		}
+		else {
+			if(m->dirty & DirtyTags)
+				redrawtags(m);
+			if(m->dirty & DirtyTitle)
+				drawtitle(m);
+		}
+		m->dirty = 0;
+	}
+	if(bars)
+		updatesystray();
+	if(done)
+		XFlush(dpy);
+	return done;
 }
 
 void
@@ -1750,10 +1944,15 @@ unsigned int
 getsystraywidth() {
 	unsigned int w = 0;
 	Client *i;
-	if(showsystray)
-		for(i = systray->icons; i; w += i->w + systrayspacing, i = i->next) ;
 
-	return w ? w + systrayspacing : 1;
+	if(!showsystray || !systray)
+		return 1;
+	if(systray->widthstale) {
+		for(i = systray->icons; i; w += i->w + systrayspacing, i = i->next) ;
+		systray->width = w ? w + systrayspacing : 1;
+		systray->widthstale = False;
+	}
+	return systray->width;
 }
 
 Bool
@@ -1788,11 +1987,11 @@ grabremap(Client *c, Bool manage) {
 	KeyCode code;
 
 	grabkeys(c->win);
-	if (c && c->remap && c->win)
-		for(i = 0; c->remap[i].keysymto; ++i)
-			if(c->remap[i].click == ClkClientWin)
+	if (c && c->info->remap && c->win)
+		for(i = 0; c->info->remap[i].keysymto; ++i)
+			if(c->info->remap[i].click == ClkClientWin)
 				for(j = 0; j < LENGTH(modifiers); j++)
-					if (c->remap[i].keysymfrom && (code = XKeysymToKeycode(dpy, c->remap[i].keysymfrom))) {
+					if (c->info->remap[i].keysymfrom && (code = XKeysymToKeycode(dpy, c->info->remap[i].keysymfrom))) {
 						if (manage) {
 							XGrabKey(dpy, code, modifiers[j], c->win,
 									True, GrabModeSync, GrabModeAsync);
@@ -1821,12 +2020,12 @@ grabbuttons(Client *c, Bool focused) {
 							GrabModeAsync, GrabModeSync, None, None);
 			button = button->next;
 		}
-		if (c->remap)
-			for(i = 0; c->remap[i].keysymto; i++)
-				if(c->remap[i].click == ClkClientWin)
+		if (c->info->remap)
+			for(i = 0; c->info->remap[i].keysymto; i++)
+				if(c->info->remap[i].click == ClkClientWin)
 					for(j = 0; j < LENGTH(modifiers); j++)
-						if (c->remap[i].mousebuttonfrom)
-							XGrabButton(dpy, c->remap[i].mousebuttonfrom,
+						if (c->info->remap[i].mousebuttonfrom)
+							XGrabButton(dpy, c->info->remap[i].mousebuttonfrom,
 									modifiers[j],
 									c->win, True, BUTTONMASK,
 									GrabModeAsync, GrabModeSync, None, CurrentTime);
@@ -1934,10 +2133,10 @@ keypress(XEvent *e) {
 		}
 		key = key->next;
 	}
-	if (selmon->sel && selmon->sel->remap) {
-		for(i = 0; selmon->sel->remap[i].keysymto; ++i)
-			if (selmon->sel->remap[i].keysymfrom && selmon->sel->remap[i].keysymfrom == keysym)
-				sendKey(XKeysymToKeycode(dpy, selmon->sel->remap[i].keysymto), selmon->sel->remap[i].modifier);
+	if (selmon->sel && selmon->sel->info->remap) {
+		for(i = 0; selmon->sel->info->remap[i].keysymto; ++i)
+			if (selmon->sel->info->remap[i].keysymfrom && selmon->sel->info->remap[i].keysymfrom == keysym)
+				sendKey(XKeysymToKeycode(dpy, selmon->sel->info->remap[i].keysymto), selmon->sel->info->remap[i].modifier);
 	}
 }
 
@@ -1984,12 +2183,12 @@ manage(Window w, XWindowAttributes *wa) {
 	Window trans = None;
 	XWindowChanges wc;
 	int bpx = 0;
+	Bool fixed;
 
-	if(!(c = calloc(1, sizeof(Client))))
-		die("fatal: could not malloc() %u bytes\n", sizeof(Client));
+	c = allocclient();
 	c->win = w;
-	c->opacity = 1.;
-	c->pid = winpid(w);
+	c->info->opacity = 1.;
+	c->info->pid = winpid(w);
 	updatetitle(c);
 	/* geometry */
 	c->w = c->oldw = wa->width;
@@ -2007,7 +2206,8 @@ manage(Window w, XWindowAttributes *wa) {
         c->x = c->oldx = wa->x + c->mon->wxo;
         c->y = c->oldy = wa->y + c->mon->wyo;
     }
-	c->oldbw = wa->border_width;
+	if(!c->isfullscreen) /* a restored fullscreen client keeps the width to go back to */
+		c->oldbw = wa->border_width;
 	if(c->x + WIDTH(c) > c->mon->mx + c->mon->mw)
 		c->x = c->mon->mx + c->mon->mw - WIDTH(c);
 	if(c->y + HEIGHT(c) > c->mon->my + c->mon->mh)
@@ -2028,7 +2228,9 @@ manage(Window w, XWindowAttributes *wa) {
 	XSetWindowBorder(dpy, w, dc.norm[ColBorder]);
 	configure(c); /* propagates border_width, if size doesn't change */
 	updatewindowtype(c);
+	fixed = c->isfixed; /* from an istransient rule or the session */
 	updatesizehints(c);
+	c->isfixed |= fixed;
 	updatewmhints(c);
 	if(c->isoverride && c->isosd)
 		XSelectInput(dpy, w, FocusChangeMask|PropertyChangeMask|StructureNotifyMask);
@@ -2093,7 +2295,7 @@ maprequest(XEvent *e) {
 		return;
 	if(wa.override_redirect)
 		return;
-	if(!wintoclient(ev->window))
+	if(!wintoclient(ev->window) && !pooltermwindow(ev->window))
 		manage(ev->window, &wa);
 }
 
@@ -2114,6 +2316,8 @@ updateopacities(Monitor *m) {
 	Client *c;
 	Client *tiledsel = NULL;
 
+	if(m->fullscreenwin)
+		return;
 	for(c = m->stack; c && !tiledsel; c = c->snext)
 		if(ISVISIBLE(c) && !ISFLOATING(c))
 			tiledsel = c;
@@ -2163,13 +2367,42 @@ motionnotify(XEvent *e) {
 	mon = m;
 }
 
+GC
+createoutlinegc(void) {
+	XGCValues gcv;
+
+	gcv.function = GXinvert;
+	gcv.subwindow_mode = IncludeInferiors;
+	gcv.line_width = borderpx;
+	return XCreateGC(dpy, root, GCFunction|GCSubwindowMode|GCLineWidth, &gcv);
+}
+
+unsigned int
+getmotioninterval(void) {
+	unsigned int rate = motionrate;
+#ifdef XRANDR
+	XRRScreenConfiguration *sc;
+
+	if(!rate && (sc = XRRGetScreenInfo(dpy, root))) {
+		rate = XRRConfigCurrentRate(sc);
+		XRRFreeScreenConfigInfo(sc);
+	}
+#endif /* XRANDR */
+	if(!rate)
+		rate = 60;
+	return 1000 / rate;
+}
+
 void
 movemouse(const Arg *arg) {
-	int x, y, ocx, ocy, nx, ny;
+	int x, y, ocx, ocy, nx, ny, ox, oy;
 	Client *c, *c2;
 	Monitor *m;
 	XEvent ev;
 	Time lasttime = 0;
+	unsigned int interval;
+	Bool pending = False, outline;
+	GC gc = NULL;
 
 	if(!(c = selmon->sel))
 		return;
@@ -2180,13 +2413,19 @@ movemouse(const Arg *arg) {
 		attachstack(c);
 	}
 	restack(selmon);
-	ocx = c->x;
-	ocy = c->y;
+	ocx = ox = nx = c->x;
+	ocy = oy = ny = c->y;
 	if(XGrabPointer(dpy, root, False, MOUSEMASK, GrabModeAsync, GrabModeAsync,
 	None, cursor[CurMove], CurrentTime) != GrabSuccess)
 		return;
 	if(!getrootptr(&x, &y))
 		return;
+	interval = getmotioninterval();
+	if((outline = outlinemove && ISFLOATING(c))) {
+		gc = createoutlinegc();
+		XGrabServer(dpy);
+		XDrawRectangle(dpy, root, gc, ox, oy, WIDTH(c) - 1, HEIGHT(c) - 1);
+	}
 	do {
 		XMaskEvent(dpy, MOUSEMASK|ExposureMask|SubstructureRedirectMask, &ev);
 		switch(ev.type) {
@@ -2196,7 +2435,8 @@ movemouse(const Arg *arg) {
 			handler[ev.type](&ev);
 			break;
 		case MotionNotify:
-			XSync(dpy, False);
+			/* only the newest queued motion matters */
+			while(XCheckMaskEvent(dpy, PointerMotionMask, &ev));
 			if(selmon->vs->lt[selmon->vs->curlt]->arrange && !c->isfloating) {
 				/* move within tesselation */
 				nx = ev.xmotion.x;
@@ -2208,10 +2448,6 @@ movemouse(const Arg *arg) {
 				}
 			} else {
 				/* move floating window */
-				if ((ev.xmotion.time - lasttime) <= (1000 / 60))
-					continue;
-				lasttime = ev.xmotion.time;
-
 				nx = ocx + (ev.xmotion.x - x);
 				ny = ocy + (ev.xmotion.y - y);
 				if (abs(selmon->wx - nx) < snap)
@@ -2222,11 +2458,27 @@ movemouse(const Arg *arg) {
 					ny = selmon->wy;
 				else if (abs((selmon->wy + selmon->wh) - (ny + HEIGHT(c))) < snap)
 					ny = selmon->wy + selmon->wh - HEIGHT(c);
-				resize(c, nx, ny, c->w, c->h, True);
+				if ((pending = (ev.xmotion.time - lasttime) < interval))
+					break;
+				lasttime = ev.xmotion.time;
+				if(outline) {
+					XDrawRectangle(dpy, root, gc, ox, oy, WIDTH(c) - 1, HEIGHT(c) - 1);
+					XDrawRectangle(dpy, root, gc, (ox = nx), (oy = ny), WIDTH(c) - 1, HEIGHT(c) - 1);
+				}
+				else
+					resize(c, nx, ny, c->w, c->h, True);
 			}
 			break;
 		}
 	} while(ev.type != ButtonRelease);
+	if(outline) {
+		XDrawRectangle(dpy, root, gc, ox, oy, WIDTH(c) - 1, HEIGHT(c) - 1);
+		XFreeGC(dpy, gc);
+		XUngrabServer(dpy);
+	}
+	/* apply the position a throttled motion or the outline left behind */
+	if((pending || outline) && (nx != c->x || ny != c->y))
+		resize(c, nx, ny, c->w, c->h, True);
 	XUngrabPointer(dpy, CurrentTime);
 	if((m = recttomon(c->x, c->y, c->w, c->h)) != selmon) {
 		sendmon(c, m);
@@ -2291,8 +2543,10 @@ propertynotify(XEvent *e) {
 		updatesystray();
 	}
 	if((ev->window == root) && (ev->atom == XA_WM_NAME)) {
-		statuscommutator ^= 1;
-		updatestatus();
+		if(!usestatusmodules) {
+			statuscommutator ^= 1;
+			updatestatus();
+		}
 	}
 	else if(ev->state == PropertyDelete)
 		return; /* ignore */
@@ -2309,15 +2563,13 @@ propertynotify(XEvent *e) {
 			updatesizehints(c);
 			break;
 		case XA_WM_HINTS:
-			updatewmhints(c);
-			drawbars();
+			/* only urgency shows in the bar, in the tags of c's monitor */
+			if(updatewmhints(c) & HintUrgency)
+				markdirty(c->mon, DirtyTags);
 			break;
 		}
-		if(ev->atom == XA_WM_NAME || ev->atom == netatom[NetWMName]) {
-			updatetitle(c);
-			if(c == c->mon->sel)
-				drawbar(c->mon);
-		}
+		if(ev->atom == XA_WM_NAME || ev->atom == netatom[NetWMName])
+			titlechanged(c);
 		if(ev->atom == netatom[NetWMWindowType])
 			updatewindowtype(c);
 	}
@@ -2328,6 +2580,16 @@ quit(const Arg *arg) {
 	running = False;
 }
 
+#ifdef XRANDR
+void
+randrnotify(XEvent *e) {
+	/* outputs are diffed in updategeom(), a hotplug only touches the
+	 * monitors whose output appeared, vanished or changed mode */
+	XRRUpdateConfiguration(e);
+	updatescreen(DisplayWidth(dpy, screen), DisplayHeight(dpy, screen));
+}
+#endif /* XRANDR */
+
 Monitor *
 recttomon(int x, int y, int w, int h) {
 	Monitor *m, *r = selmon;
@@ -2350,7 +2612,8 @@ removesystrayicon(Client *i) {
 	for(ii = &systray->icons; *ii && *ii != i; ii = &(*ii)->next);
 	if(ii)
 		*ii = i->next;
-	free(i);
+	systray->widthstale = True;
+	freeclient(i);
 }
 
 void
@@ -2445,20 +2708,27 @@ resizeclient(Client *c, int x, int y, int w, int h) {
 void
 resizemouse(const Arg *arg) {
 	int ocx, ocy;
-	int nw, nh;
+	int nw, nh, ow, oh;
 	Client *c;
 	Monitor *m;
 	XEvent ev;
+	Time lasttime = 0;
+	unsigned int interval;
+	Bool outline = False;
+	GC gc = NULL;
 
 	if(!(c = selmon->sel))
 		return;
 	restack(selmon);
 	ocx = c->x;
 	ocy = c->y;
+	ow = nw = c->w;
+	oh = nh = c->h;
 	if(XGrabPointer(dpy, root, False, MOUSEMASK, GrabModeAsync, GrabModeAsync,
 					None, cursor[CurResize], CurrentTime) != GrabSuccess)
 		return;
 	XWarpPointer(dpy, None, c->win, 0, 0, 0, 0, c->w + c->bw - 1, c->h + c->bw - 1);
+	interval = getmotioninterval();
 	do {
 		XMaskEvent(dpy, MOUSEMASK|ExposureMask|SubstructureRedirectMask, &ev);
 		switch(ev.type) {
@@ -2468,6 +2738,8 @@ resizemouse(const Arg *arg) {
 			handler[ev.type](&ev);
 			break;
 		case MotionNotify:
+			/* only the newest queued motion matters */
+			while(XCheckMaskEvent(dpy, PointerMotionMask, &ev));
 			nw = MAX(ev.xmotion.x - ocx - 2 * c->bw + 1, 1);
 			nh = MAX(ev.xmotion.y - ocy - 2 * c->bw + 1, 1);
 			if(c->mon->wx + nw >= selmon->wx
@@ -2479,11 +2751,31 @@ resizemouse(const Arg *arg) {
 				&& (abs(nw - c->w) > snap || abs(nh - c->h) > snap))
 					togglefloating(NULL);
 			}
-			if(!selmon->vs->lt[selmon->vs->curlt]->arrange || c->isfloating)
-				resize(c, c->x, c->y, nw, nh, True);
+			if(!selmon->vs->lt[selmon->vs->curlt]->arrange || c->isfloating) {
+				if((ev.xmotion.time - lasttime) < interval)
+					break;
+				lasttime = ev.xmotion.time;
+				if(outlinemove && !outline) {
+					outline = True;
+					gc = createoutlinegc();
+					XGrabServer(dpy);
+					XDrawRectangle(dpy, root, gc, c->x, c->y, ow + 2 * c->bw - 1, oh + 2 * c->bw - 1);
+				}
+				if(outline) {
+					XDrawRectangle(dpy, root, gc, c->x, c->y, ow + 2 * c->bw - 1, oh + 2 * c->bw - 1);
+					XDrawRectangle(dpy, root, gc, c->x, c->y, (ow = nw) + 2 * c->bw - 1, (oh = nh) + 2 * c->bw - 1);
+				}
+				else
+					resize(c, c->x, c->y, nw, nh, True);
+			}
 			break;
 		}
 	} while(ev.type != ButtonRelease && False == XCheckMaskEvent(dpy, ButtonReleaseMask, &ev));
+	if(outline) {
+		XDrawRectangle(dpy, root, gc, c->x, c->y, ow + 2 * c->bw - 1, oh + 2 * c->bw - 1);
+		XFreeGC(dpy, gc);
+		XUngrabServer(dpy);
+	}
 	if(!selmon->vs->lt[selmon->vs->curlt]->arrange || c->isfloating)
 		resize(c, c->x, c->y, nw, nh, True);
 	XWarpPointer(dpy, None, c->win, 0, 0, 0, 0, c->w + c->bw - 1, c->h + c->bw - 1);
@@ -2514,8 +2806,9 @@ restackwindows() {
 	Client *c;
 	Window *windows;
 	int nwindows = 0;
-	int w = 0;
+	int w = 0, i;
 
+	STATS_COUNT(restacks);
 	XGrabServer(dpy);
 	resizebackwins();
 	for(m = mons; m; m = m->next) {
@@ -2527,13 +2820,14 @@ restackwindows() {
 	}
 	if(dockwin)
 		++nwindows;
+	if(showsystray && systray)
+		++nwindows;
 	if(nwindows > 1) {
 		windows = (Window *)calloc(nwindows, sizeof(Window));
-		// notifications
-		for(m = mons; m; m = m->next)
-			for(c = m->stack; c && w < nwindows; c = c->snext)
-				if(c->isosd)
-					windows[w++] = c->win;
+		// notifications, in stacking order
+		sortclientset(&osdclients, True);
+		for(i = 0; i < osdclients.n && w < nwindows; ++i)
+			windows[w++] = osdclients.v[i]->win;
 		// visible floating
 		for(m = mons; m && w < nwindows; m = m->next)
 			for(c = m->stack; c; c = c->snext)
@@ -2544,6 +2838,9 @@ restackwindows() {
 			for(c = m->stack; c && w < nwindows; c = c->snext)
 				if(ISVISIBLE(c) && !c->nofocus && c->isfullscreen && c->win != m->barwin && c->win != dockwin && !c->isosd && c->win != c->mon->backwin)
 					windows[w++] = c->win;
+		// systray, right above its bar
+		if(showsystray && systray && w < nwindows)
+			windows[w++] = systray->win;
 		// bar
 		for(m = mons; m && w < nwindows; m = m->next)
 			if(m->barwin)
@@ -2561,11 +2858,13 @@ restackwindows() {
 			for(c = m->stack; c && w < nwindows; c = c->snext)
 				if(ISVISIBLE(c) && !ISFLOATING(c) && c != m->sel && !c->nofocus && !c->isfullscreen && !c->isosd && c->win != c->mon->backwin)
 					windows[w++] = c->win;
-		// nofocus
-		for(m = mons; m && w < nwindows; m = m->next)
-			for(c = m->stack; c; c = c->snext)
-				if(ISVISIBLE(c) && c != m->sel && c->nofocus && !c->isosd)
-					windows[w++] = c->win;
+		// nofocus, in stacking order
+		sortclientset(&nofocusclients, True);
+		for(i = 0; i < nofocusclients.n && w < nwindows; ++i) {
+			c = nofocusclients.v[i];
+			if(ISVISIBLE(c) && c != c->mon->sel && !c->isosd)
+				windows[w++] = c->win;
+		}
 		// desktop window (plasmashell)
 		for(m = mons; m && w < nwindows; m = m->next)
 			if(m->backwin)
@@ -2603,6 +2902,27 @@ restack(Monitor *m) {
 	restackwindows();
 }
 
+/* c took the focus from old on the same monitor; when both are plain tiled
+ * windows only their relative order changes, restackwindows() is not needed */
+void
+restackpair(Client *c, Client *old) {
+	XWindowChanges wc;
+
+	if(old->mon != c->mon || !ISVISIBLE(old) || !ISVISIBLE(c)
+	|| ISFLOATING(c) || ISFLOATING(old) || c->isfullscreen || old->isfullscreen
+	|| c->nofocus || old->nofocus || c->isosd || old->isosd
+	|| c->win == c->mon->backwin || old->win == c->mon->backwin) {
+		restackdirty = True;
+		return;
+	}
+	wc.sibling = old->win;
+	wc.stack_mode = Above;
+	XConfigureWindow(dpy, c->win, CWSibling|CWStackMode, &wc);
+	wc.sibling = c->win;
+	wc.stack_mode = Below;
+	XConfigureWindow(dpy, old->win, CWSibling|CWStackMode, &wc);
+}
+
 void
 restorebar(Monitor* m) {
 	if (m->vs->showbar != BARSHOWN(m))
@@ -2612,11 +2932,61 @@ restorebar(Monitor* m) {
 void
 run(void) {
 	XEvent ev;
-	/* main event loop */
+	struct pollfd fds[5 + LENGTH(statusmodules)] = { { ConnectionNumber(dpy), POLLIN, 0 } };
+	int i;
+
+	/* main event loop, timers and the reload pipe are polled next to the
+	 * X connection and signals interrupt the poll */
 	XSync(dpy, False);
-	while(running && !XNextEvent(dpy, &ev))
-		if(ev.type < LASTEvent && handler[ev.type])
+	while(running) {
+		if(reloadpending) {
+			reloadpending = 0;
+			swapconfig();
+		}
+		STATS_POLL();
+		if(!XPending(dpy)) {
+			if(flushdirty())
+				continue;
+			fds[1].fd = clockfd;
+			fds[1].events = POLLIN;
+			fds[2].fd = hoverfd;
+			fds[2].events = POLLIN;
+			fds[3].fd = titlefd;
+			fds[3].events = POLLIN;
+			fds[4].fd = reloadpipe[0];
+			fds[4].events = POLLIN;
+			for(i = 0; i < LENGTH(statusmodules); ++i) {
+				fds[5 + i].fd = statusfds[i];
+				fds[5 + i].events = POLLIN;
+			}
+			if(poll(fds, LENGTH(fds), -1) <= 0)
+				continue;
+			if(fds[2].revents & POLLIN)
+				tickhover();
+			if(fds[3].revents & POLLIN)
+				ticktitles();
+			if(fds[1].revents & POLLIN)
+				tickclocks();
+			if(fds[4].revents & POLLIN)
+				tickreload();
+			for(i = 0; i < LENGTH(statusmodules); ++i)
+				if(fds[5 + i].revents & POLLIN)
+					tickstatus(i);
+			continue;
+		}
+		XNextEvent(dpy, &ev);
+		if(ev.type < LASTEvent && handler[ev.type]) {
+			if(trace)
+				recordevent(&ev);
+			STATS_EVENT_BEGIN();
 			handler[ev.type](&ev); /* call handler */
+			STATS_EVENT_END(ev.type);
+		}
+#ifdef XRANDR
+		else if(randrmonitors && (ev.type == rrevbase + RRScreenChangeNotify || ev.type == rrevbase + RRNotify))
+			randrnotify(&ev);
+#endif /* XRANDR */
+	}
 }
 
 Bool
@@ -2736,6 +3106,19 @@ setclientstate(Client *c, long state) {
 			PropModeReplace, (unsigned char *)data, 2);
 }
 
+void
+setnetwmstate(Client *c) {
+	Atom state[2];
+	int n = 0;
+
+	if(c->isfullscreen)
+		state[n++] = netatom[NetWMFullscreen];
+	if(c->ishidden)
+		state[n++] = netatom[NetWMHidden];
+	XChangeProperty(dpy, c->win, netatom[NetWMState], XA_ATOM, 32,
+			PropModeReplace, (unsigned char *)state, n);
+}
+
 void setdesktopnames(void) {
 	XTextProperty text;
 	Xutf8TextListToTextProperty(dpy, tags, TAGSLENGTH, XUTF8StringStyle, &text);
@@ -2803,6 +3186,32 @@ monhasfullscreenclient(Monitor *m) {
 	return NULL;
 }
 
+/* While a visible fullscreen client covers m, the compositor is asked to
+ * unredirect it and the bar, clock, status and opacities of m are frozen;
+ * they are brought up to date at once when it goes away. */
+void
+updatefullscreenmode(Monitor *m) {
+	Client *c = monhasfullscreenclient(m);
+	Window w = c && ISVISIBLE(c) ? c->win : 0;
+	long bypass = 1;
+
+	if(w == m->fullscreenwin)
+		return;
+	if(m->fullscreenwin)
+		XDeleteProperty(dpy, m->fullscreenwin, netatom[NetWMBypassCompositor]);
+	if(w)
+		XChangeProperty(dpy, w, netatom[NetWMBypassCompositor], XA_CARDINAL, 32,
+						PropModeReplace, (unsigned char *)&bypass, 1);
+	m->fullscreenwin = w;
+	if(!w) {
+		updateopacities(m);
+		drawbar(m);
+		drawclock(m);
+		if(m == selmon)
+			updatesystray();
+	}
+}
+
 void
 setfullscreen(Client *c, Bool fullscreen) {
 	Monitor *m;
@@ -2834,13 +3243,12 @@ setfullscreen(Client *c, Bool fullscreen) {
 			return ;
 		c->actual_opacity = (unsigned int)-1;
 		window_opacity_set(c->win, c->actual_opacity);
-		XChangeProperty(dpy, c->win, netatom[NetWMState], XA_ATOM, 32,
-						PropModeReplace, (unsigned char*)&netatom[NetWMFullscreen], 1);
 		if (!c->isfullscreen) {
 			c->isfullscreen = c->tags;
 			c->oldstate = c->isfloating;
 			c->oldbw = c->bw;
 		}
+		setnetwmstate(c);
 		c->bw = 0;
 		c->isfloating = True;
         if (!(c->tags & vtag))
@@ -2850,11 +3258,10 @@ setfullscreen(Client *c, Bool fullscreen) {
 	}
 	else {
 		setclientopacity(c);
-		XChangeProperty(dpy, c->win, netatom[NetWMState], XA_ATOM, 32,
-						PropModeReplace, (unsigned char*)0, 0);
 		if(c->isfullscreen)
 			c->tags = c->isfullscreen;
 		c->isfullscreen = 0;
+		setnetwmstate(c);
 		c->isfloating = c->oldstate;
 		c->bw = c->oldbw;
 		c->x = c->oldx;
@@ -2991,12 +3398,15 @@ updatecolors(const Arg *arg) {
 			c = icons;
 			while (c) {
 				icons = c->next;
-				free(c);
+				freeclient(c);
 				c = icons;
 			}
 		}
 	}
-	createclocks();
+	for(m = mons; m; m = m->next)
+		if(m->clock)
+			XSetWindowBackground(dpy, m->clock, dc.norm[ColBG]);
+	drawclocks();
 }
 
 void
@@ -3015,12 +3425,14 @@ setup(void) {
 
 	/* clean up any zombies immediately */
 	sigchld(0);
+	STATS_INIT();
 
 	/* read colors */
 	readcolors();
 
 	/* read config */
 	readconfig();
+	startreload();
 
 	*ooftraysbl = 0;
 	if (outoffocustraysymbol)
@@ -3036,6 +3448,16 @@ setup(void) {
 	sh = DisplayHeight(dpy, screen);
 	dc.font.padding = 2;
 	bh = dc.h = dc.font.height + dc.font.padding;
+#ifdef XRANDR
+	{
+		int rrerrbase, major = 0, minor = 0;
+
+		if(XRRQueryExtension(dpy, &rrevbase, &rrerrbase) && XRRQueryVersion(dpy, &major, &minor))
+			randrmonitors = major > 1 || (major == 1 && minor >= 5);
+		if(randrmonitors)
+			XRRSelectInput(dpy, root, RRScreenChangeNotifyMask|RROutputChangeNotifyMask);
+	}
+#endif /* XRANDR */
 	updategeom();
 	/* init atoms */
 	wmatom[WMProtocols] = XInternAtom(dpy, "WM_PROTOCOLS", False);
@@ -3063,6 +3485,8 @@ setup(void) {
 	netatom[NetWMStateSkipTaskbar] = XInternAtom(dpy, "_NET_WM_STATE_SKIP_TASKBAR", False);
 	netatom[NetWMDesktop] = XInternAtom(dpy, "_NET_WM_DESKTOP", False);
 	netatom[NetWMOpacity] = XInternAtom(dpy, "_NET_WM_WINDOW_OPACITY", False);
+	netatom[NetWMBypassCompositor] = XInternAtom(dpy, "_NET_WM_BYPASS_COMPOSITOR", False);
+	netatom[NetWMHidden] = XInternAtom(dpy, "_NET_WM_STATE_HIDDEN", False);
 	netatom[NetClientList] = XInternAtom(dpy, "_NET_CLIENT_LIST", False);
 	netatom[NetDesktopViewport] = XInternAtom(dpy, "_NET_DESKTOP_VIEWPORT", False);
 	netatom[NetDesktopGeometry] = XInternAtom(dpy, "_NET_DESKTOP_GEOMETRY", False);
@@ -3094,6 +3518,7 @@ setup(void) {
 	/* init system tray */
 	updatesystray();
 	updatebars();
+	startstatus();
 	updatestatus();
 	/* EWMH support per view */
 	XChangeProperty(dpy, root, netatom[NetSupported], XA_ATOM, 32,
@@ -3111,7 +3536,7 @@ setup(void) {
 	XSelectInput(dpy, root, wa.event_mask);
 	grabkeys(root);
 	startuserscript();
-	killclocks();
+	spawnimpl(&(Arg){ .v = compositorcmd }, False, False);
 	createclocks();
 }
 
@@ -3167,18 +3592,55 @@ shouldbeopaque(Client *c, Client *tiledsel) {
 
 void
 showhide(Client *c) {
-	if(!c)
-		return;
-	if(ISVISIBLE(c)) { /* show clients top down */
+	static Client **hide = NULL;
+	static int hidesize = 0;
+	int n = 0;
+
+	/* only clients whose visibility changed, or that were (re)attached to a
+	 * monitor since the last pass, are touched; the layout places the rest */
+	for(; c; c = c->snext) {
+		if(!ISVISIBLE(c)) {
+			if(c->isshown || !c->isplaced) {
+				if(n == hidesize) {
+					hidesize = hidesize ? hidesize * 2 : 64;
+					if(!(hide = realloc(hide, hidesize * sizeof(Client *))))
+						die("fatal: could not malloc() %u bytes\n", hidesize * sizeof(Client *));
+				}
+				hide[n++] = c;
+			}
+			continue;
+		}
+		if(c->isshown && c->isplaced)
+			continue;
+		/* show clients top down */
+		c->isshown = c->isplaced = True;
 		setclientstate(c, NormalState);
+		if(c->ishidden) {
+			c->ishidden = False;
+			setnetwmstate(c);
+			XMapWindow(dpy, c->win);
+		}
 		if (!c->mon->backwin)
 			XMoveWindow(dpy, c->win, c->x, c->y);
 		if((!c->mon->vs->lt[c->mon->vs->curlt]->arrange || c->isfloating) && (!c->isfullscreen || rotatingMons))
 			resize(c, c->x, c->y, c->w, c->h, False);
-		showhide(c->snext);
 	}
-	else { /* hide clients bottom up */
-		showhide(c->snext);
+	/* hide clients bottom up */
+	while(n--) {
+		c = hide[n];
+		c->isshown = False;
+		c->isplaced = True;
+		if(hidebyunmap && !c->mon->backwin) {
+			/* iconic, not withdrawn: it is still managed; cleanup() maps it again */
+			setclientstate(c, IconicState);
+			if(!c->ishidden) {
+				c->ishidden = True;
+				setnetwmstate(c);
+				c->info->unmapsexpected++;
+				XUnmapWindow(dpy, c->win);
+			}
+			continue;
+		}
 		setclientstate(c, WithdrawnState);
 		if (!c->mon->backwin)
 			XMoveWindow(dpy, c->win, WIDTH(c) * -2, c->y);
@@ -3187,9 +3649,12 @@ showhide(Client *c) {
 
 void
 sigchld(int unused) {
+	pid_t pid;
+
 	if(signal(SIGCHLD, sigchld) == SIG_ERR)
 		die("Can't install SIGCHLD handler");
-	while(0 < waitpid(-1, NULL, WNOHANG));
+	while(0 < (pid = waitpid(-1, NULL, WNOHANG)))
+		reappoolterm(pid);
 }
 
 void
@@ -3212,19 +3677,30 @@ spawnimpl(const Arg *arg, Bool waitdeath, Bool useshcmd) {
 	}
 }
 
-void
-spawnterm(const Arg* arg) {
-	int childpid = fork();
+pid_t
+forkterm(void) {
+	pid_t childpid = fork();
 	const char** termcmd = (const char**)terminal;
+	sigset_t none;
 
 	if(childpid == 0) {
+		/* the terminal pool forks with SIGCHLD blocked */
+		sigemptyset(&none);
+		sigprocmask(SIG_SETMASK, &none, NULL);
 		if (termcmd[0] == NULL)
 			termcmd = defaultterminal;
 		execvp(termcmd[0], (char**)termcmd);
-		fprintf(stderr, "dwm: execvp %s", ((char **)arg->v)[0]);
+		fprintf(stderr, "dwm: execvp %s", termcmd[0]);
 		perror(" failed");
 		exit(EXIT_SUCCESS);
 	}
+	return childpid;
+}
+
+void
+spawnterm(const Arg* arg) {
+	if(!claimpoolterm())
+		forkterm();
 }
 
 void
@@ -3238,13 +3714,13 @@ systrayaddwindow (Window win) {
 	XSetWindowAttributes swa;
 	Client* c;
 
-	if(!(c = (Client *)calloc(1, sizeof(Client))))
-		die("fatal: could not malloc() %u bytes\n", sizeof(Client));
+	c = allocclient();
 	c->mon = selmon;
 	c->win = win;
-	c->opacity = 1.;
+	c->info->opacity = 1.;
 	c->next = systray->icons;
 	systray->icons = c;
+	systray->widthstale = True;
 	XGetWindowAttributes(dpy, c->win, &wa);
 	c->x = c->oldx = c->y = c->oldy = 0;
 	c->w = c->oldw = wa.width;
@@ -3343,8 +3819,10 @@ int
 textnw(const char *text, unsigned int len) {
 	PangoRectangle r;
 
+	STATS_PANGO_BEGIN();
 	pango_layout_set_text(dc.cairo.layout, text, len);
 	pango_layout_get_extents(dc.cairo.layout, 0, &r);
+	STATS_PANGO_END();
 	return r.width / PANGO_SCALE;
 }
 
@@ -3363,6 +3841,7 @@ monshowbar(Monitor* m, Bool show) {
 				wc.y = m->mh - bh;
 		}
 		XConfigureWindow(dpy, systray->win, CWY, &wc);
+		systray->y = wc.y;
 	}
 	arrange(m);
 }
@@ -3382,8 +3861,7 @@ void
 toggledock(const Arg *arg) {
 	Monitor *m;
 
-	for (m = mons; m && m->num != dockmonitor; m = m->next);
-	if (m)
+	if ((m = dockmon()))
 		monshowdock(m, !m->vs->showdock);
 }
 
@@ -3506,7 +3984,7 @@ unmanage(Client *c, Bool destroyed) {
 		XSetErrorHandler(xerror);
 		XUngrabServer(dpy);
 	}
-	free(c);
+	freeclient(c);
 	if(m == selmon)
 		focus(NULL);
     updateclientlist();
@@ -3519,8 +3997,16 @@ unmapnotify(XEvent *e) {
 	Client *c;
 	XUnmapEvent *ev = &e->xunmap;
 
-	if((c = wintoclient(ev->window)))
+	if((c = wintoclient(ev->window))) {
+		/* our own hiding unmaps are reported on the window and on root,
+		 * the root copy settles the count */
+		if(c->info->unmapsexpected && !ev->send_event) {
+			if(ev->event == root)
+				c->info->unmapsexpected--;
+			return;
+		}
 		unmanage(c, False);
+	}
 	else if((c = wintosystrayicon(ev->window))) {
 		XMapRaised(dpy, c->win);
 		updatesystray();
@@ -3531,13 +4017,14 @@ void
 updateborderswidth(Monitor* m) {
 	Client* c;
 	Bool changed = False;
+	Bool isdock = (m == dockmon());
 	unsigned int nc, bw;
 
 	nc = counttiledclients(m);
 	for(c = m->clients; c; c = c->next)
 		if (ISVISIBLE(c) && !c->nofocus && !c->isfullscreen) {
 			bw = 0;
-			if ((nc > 1 || c->isfloating || !m->vs->lt[m->vs->curlt]->arrange || m->vs->showdock && m->num == dockmonitor) && !c->noborder)
+			if ((nc > 1 || c->isfloating || !m->vs->lt[m->vs->curlt]->arrange || m->vs->showdock && isdock) && !c->noborder)
 				bw = m->vs->lt[m->vs->curlt]->borderpx;
 			if (c->bw != bw) {
 				c->bw = bw;
@@ -3619,12 +4106,10 @@ updateclientdesktop(Client* c) {
 
 void
 updatecurrentdesktop(void) {
-	Monitor *m = mons;
+	Monitor *m = dockmon();
 	Client *c;
 	long data;
 
-	while (m && m->num != dockmonitor)
-		m = m->next;
 	if (m) {
 		data = tagsettonum(m->vs->tagset);
 
@@ -3636,7 +4121,7 @@ updatecurrentdesktop(void) {
  
 void
 updatedockpos(Monitor *m) {
-	if (m->vs->showdock && m->num == dockmonitor) {
+	if (m->vs->showdock && m == dockmon()) {
 		switch (dockposition)
 		{
 		case Top:
@@ -3659,123 +4144,196 @@ updatedockpos(Monitor *m) {
 	}
 }
 
-void
-killclocks(void) {
-	Monitor *m;
-	const Arg arg = {.v = killclockscmd };
-	spawnimpl(&arg, True, False);
+#ifdef XRANDR
+int
+getrandrscreens(ScreenGeom **screens) {
+	int i, j, k, n;
+	char *name;
+	XRRMonitorInfo *info;
 
-	for(m = mons; m; m = m->next)
-		m->clock = 0;
+	if(!randrmonitors || !(info = XRRGetMonitors(dpy, root, True, &n)))
+		return 0;
+	if(!(*screens = (ScreenGeom *)calloc(n, sizeof(ScreenGeom))))
+		die("fatal: could not malloc() %u bytes\n", sizeof(ScreenGeom) * n);
+	for(i = 0, j = 0; i < n; i++) {
+		/* like isuniquegeom(): clones share an origin, first screen wins */
+		for(k = 0; k < j && ((*screens)[k].x != info[i].x || (*screens)[k].y != info[i].y); k++);
+		if(k < j)
+			continue;
+		(*screens)[j].x = info[i].x;
+		(*screens)[j].y = info[i].y;
+		(*screens)[j].w = info[i].width;
+		(*screens)[j].h = info[i].height;
+		if((name = XGetAtomName(dpy, info[i].name))) {
+			strncpy((*screens)[j].name, name, sizeof (*screens)[j].name - 1);
+			XFree(name);
+		}
+		j++;
+	}
+	XRRFreeMonitors(info);
+	return j;
 }
+#endif /* XRANDR */
 
-void
-createclocks(void) {
-	Monitor* m;
+#ifdef XINERAMA
+int
+getxineramascreens(ScreenGeom **screens) {
+	int i, j, n;
+	XineramaScreenInfo *info, *unique;
 
-	for(m = mons; m; m = m->next) {
-		const Arg arg = {.v = clockcmd };
-		spawnimpl(&arg, False, False);
-	}
+	if(!XineramaIsActive(dpy) || !(info = XineramaQueryScreens(dpy, &n)))
+		return 0;
+	/* only consider unique geometries as separate screens */
+	if(!(unique = (XineramaScreenInfo *)malloc(sizeof(XineramaScreenInfo) * n)))
+		die("fatal: could not malloc() %u bytes\n", sizeof(XineramaScreenInfo) * n);
+	for(i = 0, j = 0; i < n; i++)
+		if(isuniquegeom(unique, j, &info[i]))
+			memcpy(&unique[j++], &info[i], sizeof(XineramaScreenInfo));
+	XFree(info);
+	if(!(*screens = (ScreenGeom *)calloc(j, sizeof(ScreenGeom))))
+		die("fatal: could not malloc() %u bytes\n", sizeof(ScreenGeom) * j);
+	for(i = 0; i < j; i++) {
+		(*screens)[i].x = unique[i].x_org;
+		(*screens)[i].y = unique[i].y_org;
+		(*screens)[i].w = unique[i].width;
+		(*screens)[i].h = unique[i].height;
+	}
+	free(unique);
+	return j;
 }
+#endif /* XINERAMA */
 
-void
+Bool
 updategeom(void) {
-	/* Starting with dwm 6.1 this function uses a new (simpler) strategy:
-	 * whenever screen changes are reported, we destroy all monitors
-	 * and recreate all unique origin monitors and add all clients to
-	 * the first monitor, only. In several circumstances this may suck,
-	 * but dealing with all corner-cases sucks even more.*/
+	/* Screen changes are applied as a diff: monitors whose output kept its
+	 * geometry are left alone, monitors whose output moved or changed
+	 * resolution are reused (keeping bar, view stacks and clients) and
+	 * only monitors that disappeared are destroyed, their clients going
+	 * to the first monitor. Outputs are matched by RandR name when known,
+	 * then by geometry. Every monitor that needs a relayout is flagged
+	 * with reconfigured. */
+	Bool dirty = False;
+	int i, n = 0, dx, dy;
+	Client *c;
+	Monitor *m, *om, **newmons, *oldmons = mons;
+	ScreenGeom *screens = NULL;
 
+	for(m = mons; m; m = m->next)
+		m->reconfigured = False;
+#ifdef XRANDR
+	n = getrandrscreens(&screens);
+#endif /* XRANDR */
 #ifdef XINERAMA
-	if(XineramaIsActive(dpy)) {
-		int i, j, n;
-		Client *c;
-		Monitor *oldmons = mons;
-		Monitor *m, *om = oldmons, *nm, *ocm, *cm;
-		XineramaScreenInfo *info = XineramaQueryScreens(dpy, &n);
-		XineramaScreenInfo *unique = NULL;
-
-		/* only consider unique geometries as separate screens */
-		if(!(unique = (XineramaScreenInfo *)malloc(sizeof(XineramaScreenInfo) * n)))
-			die("fatal: could not malloc() %u bytes\n", sizeof(XineramaScreenInfo) * n);
-		for(i = 0, j = 0; i < n; i++)
-			if(isuniquegeom(unique, j, &info[i]))
-				memcpy(&unique[j++], &info[i], sizeof(XineramaScreenInfo));
-		XFree(info);
-		/* create new monitor structure */
-		n = j;
-		mons = m = createmon(); /* new first monitor */
-		for(i = 1; i < n; i++) {
-			m->next = createmon();
-			m = m->next;
-		}
-		for(i = 0, m = mons; i < n && m; m = m->next, i++) {
+	if(!n)
+		n = getxineramascreens(&screens);
+#endif /* XINERAMA */
+	if(n) {
+		if(!(newmons = (Monitor **)calloc(n, sizeof(Monitor *))))
+			die("fatal: could not malloc() %u bytes\n", sizeof(Monitor *) * n);
+		/* same output name, or unchanged geometry for unnamed outputs */
+		for(i = 0; i < n; i++)
+			for(m = oldmons; m; m = m->next)
+				if(!m->reconfigured && (*screens[i].name
+				? !strcmp(m->outputname, screens[i].name)
+				: m->mx == screens[i].x && m->my == screens[i].y
+				  && m->mw == screens[i].w && m->mh == screens[i].h)) {
+					m->reconfigured = True; /* matched, cleared below */
+					newmons[i] = m;
+					break;
+				}
+		/* outputs that changed reuse a left over monitor, same origin first */
+		for(i = 0; i < n; i++)
+			if(!newmons[i])
+				for(m = oldmons; m; m = m->next)
+					if(!m->reconfigured && m->mx == screens[i].x && m->my == screens[i].y) {
+						m->reconfigured = True;
+						newmons[i] = m;
+						break;
+					}
+		for(i = 0; i < n; i++)
+			if(!newmons[i]) {
+				for(m = oldmons; m && m->reconfigured; m = m->next);
+				newmons[i] = m ? m : createmon();
+				newmons[i]->reconfigured = True;
+			}
+		for(i = 0; i < n; i++) {
+			m = newmons[i];
+			if(m->num != i || strcmp(m->outputname, screens[i].name))
+				dirty = True;
 			m->num = i;
-			m->wxo = m->mx = m->wx = unique[i].x_org;
-			m->wyo = m->my = m->wy = unique[i].y_org;
-			m->wwo = m->mw = m->ww = unique[i].width;
-			m->who = m->mh = m->wh = unique[i].height;
+			strcpy(m->outputname, screens[i].name);
+			if(m->mx == screens[i].x && m->my == screens[i].y
+			&& m->mw == screens[i].w && m->mh == screens[i].h && m->barwin) {
+				m->reconfigured = False;
+				continue;
+			}
+			/* keep floating clients at the same place relative to the output */
+			dx = screens[i].x - m->mx;
+			dy = screens[i].y - m->my;
+			if(m->barwin)
+				for(c = m->clients; c; c = c->next)
+					if(c->isfloating && !c->isfullscreen) {
+						c->x += dx;
+						c->y += dy;
+					}
+			m->wxo = m->mx = m->wx = screens[i].x;
+			m->wyo = m->my = m->wy = screens[i].y;
+			m->wwo = m->mw = m->ww = screens[i].w;
+			m->who = m->mh = m->wh = screens[i].h;
 			updatebarpos(m);
+			dirty = True;
 		}
-		free(unique);
-		/* re-attach old clients and cleanup old monitor structure */
-		nm = mons;
-		while(om) {
-			m = om;
-			while(m->clients) {
-				c = m->clients;
-				m->clients = c->next;
-				detachstack(c);
-				for(ocm = oldmons, cm = mons; ocm && cm && ocm != c->mon; ocm = ocm->next, cm = cm->next);
-				if(cm)
-					c->mon = cm;
-				else
-					c->mon = mons;
+		free(screens);
+		/* re-attach clients of vanished outputs and free their monitor */
+		while(oldmons) {
+			om = oldmons;
+			oldmons = oldmons->next;
+			for(i = 0; i < n && newmons[i] != om; i++);
+			if(i < n)
+				continue;
+			while((c = om->clients)) {
+				om->clients = c->next;
+				c->mon = newmons[0];
 				attach(c);
 				attachstack(c);
 			}
-			om = m->next;
-			if (nm) {
-				nm->vs = m->vs;
-				m->vs = NULL;
-				nm = nm->next;
-			}
-		}
-		XGrabServer(dpy);
-		for(; om; om = om->next)
-			if(om->clock) {
-				XKillClient(dpy, om->clock);
-				XSync(dpy, False);
-			}
-		XSetErrorHandler(xerror);
-		XUngrabServer(dpy);
-		while (oldmons) {
-			om = oldmons;
+			destroyclock(om);
+			newmons[0]->reconfigured = True;
+			if(selmon == om)
+				selmon = NULL;
 			XUnmapWindow(dpy, om->barwin);
 			XDestroyWindow(dpy, om->barwin);
-			oldmons = oldmons->next;
+			cleanupviewstack(om->vs);
+			if(lastfocusmon == om)
+				lastfocusmon = NULL;
 			free(om);
+			dirty = True;
 		}
-		resetprimarymonitor();
+		for(mons = newmons[0], i = 1; i < n; i++)
+			newmons[i - 1]->next = newmons[i];
+		newmons[n - 1]->next = NULL;
+		free(newmons);
+		if(dirty)
+			resetprimarymonitor();
 	}
-	else
-#endif /* XINERAMA */
 	/* default monitor setup */
-	{
-		if(!mons) /* only true if !XINERAMA compile flag */
+	else {
+		if(!mons) /* only true if no multi-head extension is available */
 			mons = createmon();
 		if(mons->mw != sw || mons->mh != sh) {
 			mons->mw = mons->ww = sw;
 			mons->mh = mons->wh = sh;
 			updatebarpos(mons);
+			mons->reconfigured = dirty = True;
 		}
 	}
-	if (selmon != mons) {
+	if(!selmon) {
 		selectmon(mons);
 		centerMouseInMonitorIndex(focusmonstart);
 	}
-	selectmon(wintomon(root));
+	if(dirty)
+		selectmon(wintomon(root));
+	return dirty;
 }
 
 void
@@ -3802,53 +4360,53 @@ updatesizehints(Client *c) {
 		/* size is uninitialized, ensure that size.flags aren't used */
 		size.flags = PSize;
 	if(size.flags & PBaseSize) {
-		c->basew = size.base_width;
-		c->baseh = size.base_height;
+		c->info->basew = size.base_width;
+		c->info->baseh = size.base_height;
 	}
 	else if(size.flags & PMinSize) {
-		c->basew = size.min_width;
-		c->baseh = size.min_height;
+		c->info->basew = size.min_width;
+		c->info->baseh = size.min_height;
 	}
 	else
-		c->basew = c->baseh = 0;
+		c->info->basew = c->info->baseh = 0;
 	if(size.flags & PResizeInc) {
-		c->incw = size.width_inc;
-		c->inch = size.height_inc;
+		c->info->incw = size.width_inc;
+		c->info->inch = size.height_inc;
 	}
 	else
-		c->incw = c->inch = 0;
+		c->info->incw = c->info->inch = 0;
 	if(size.flags & PMaxSize) {
-		c->maxw = size.max_width;
-		c->maxh = size.max_height;
+		c->info->maxw = size.max_width;
+		c->info->maxh = size.max_height;
 	}
 	else
-		c->maxw = c->maxh = 0;
+		c->info->maxw = c->info->maxh = 0;
 	if(size.flags & PMinSize) {
-		c->minw = size.min_width;
-		c->minh = size.min_height;
+		c->info->minw = size.min_width;
+		c->info->minh = size.min_height;
 	}
 	else if(size.flags & PBaseSize) {
-		c->minw = size.base_width;
-		c->minh = size.base_height;
+		c->info->minw = size.base_width;
+		c->info->minh = size.base_height;
 	}
 	else
-		c->minw = c->minh = 0;
+		c->info->minw = c->info->minh = 0;
 	if(size.flags & PAspect) {
-		c->mina = (float)size.min_aspect.y / size.min_aspect.x;
-		c->maxa = (float)size.max_aspect.x / size.max_aspect.y;
+		c->info->mina = (float)size.min_aspect.y / size.min_aspect.x;
+		c->info->maxa = (float)size.max_aspect.x / size.max_aspect.y;
 	}
 	else
-		c->maxa = c->mina = 0.0;
-	c->isfixed = (c->maxw && c->minw && c->maxh && c->minh
-				 && c->maxw == c->minw && c->maxh == c->minh);
+		c->info->maxa = c->info->mina = 0.0;
+	c->isfixed = (c->info->maxw && c->info->minw && c->info->maxh && c->info->minh
+				 && c->info->maxw == c->info->minw && c->info->maxh == c->info->minh);
 }
 
 void
 updatetitle(Client *c) {
-	if(!gettextprop(c->win, netatom[NetWMName], c->name, sizeof c->name))
-		gettextprop(c->win, XA_WM_NAME, c->name, sizeof c->name);
-	if(c->name[0] == '\0') /* hack to mark broken clients */
-		strcpy(c->name, broken);
+	if(!gettextprop(c->win, netatom[NetWMName], c->info->name, sizeof c->info->name))
+		gettextprop(c->win, XA_WM_NAME, c->info->name, sizeof c->info->name);
+	if(c->info->name[0] == '\0') /* hack to mark broken clients */
+		strcpy(c->info->name, broken);
 }
 
 long
@@ -3870,7 +4428,7 @@ getmodtimefor (const char* filepath)
 }
 
 void
-checkconfigtimes() {
+checkconfigtimes(void) {
 	const char* homedir = getenv("HOME");
 	const char* relconfig = ".config/dwm/colors";
 	char* colorFile = calloc(strlen(homedir) + strlen(relconfig) + 2, sizeof(char));
@@ -3900,7 +4458,7 @@ checkconfigtimes() {
 void
 updatestatus(void) {
 	Monitor* m;
-	if(!gettextprop(root, XA_WM_NAME, stext, sizeof(stext)))
+	if(!usestatusmodules && !gettextprop(root, XA_WM_NAME, stext, sizeof(stext)))
 		strcpy(stext, "dwm-"VERSION);
 	if (statusallmonitor) {
 		for(m = mons; m; m = m->next)
@@ -3930,6 +4488,9 @@ updatesystrayicongeom(Client *i, int w, int h) {
 				i->w = (int) ((float)bh * ((float)i->w / (float)i->h));
 			i->h = bh;
 		}
+		/* placed again by the next updatesystray() */
+		i->isplaced = False;
+		systray->widthstale = True;
 	}
 }
 
@@ -3960,6 +4521,10 @@ updatesystrayiconstate(Client *i, XPropertyEvent *ev) {
 			systray->win, XEMBED_EMBEDDED_VERSION);
 }
 
+/* Icons keep the place they were given: isplaced is cleared when an icon
+ * changes size and isshown once it is mapped, so only icons that changed or
+ * moved because one before them did are reconfigured, and the tray window
+ * itself only when its geometry or background changed. */
 void
 updatesystray(void) {
 	XSetWindowAttributes wa;
@@ -3996,31 +4561,45 @@ updatesystray(void) {
 			systray = NULL;
 			return;
 		}
+		systray->bg = dc.norm[ColBG];
+		systray->widthstale = True;
 	}
 	for(w = 0, i = systray->icons; i; i = i->next) {
-		/* make sure the background color stays the same */
-		wa.background_pixel  = dc.norm[ColBG];
-		XChangeWindowAttributes(dpy, i->win, CWBackPixel, &wa);
-		XMapRaised(dpy, i->win);
 		w += systrayspacing;
-		i->x = w;
-		XMoveResizeWindow(dpy, i->win, i->x, 0, i->w, i->h);
+		if(!i->isplaced || i->x != w) {
+			i->x = w;
+			i->isplaced = True;
+			XMoveResizeWindow(dpy, i->win, i->x, 0, i->w, i->h);
+		}
+		/* tags is the XEMBED mapped status */
+		if(!i->isshown && i->tags) {
+			i->isshown = True;
+			XMapRaised(dpy, i->win);
+		}
 		w += i->w;
-		if(i->mon != m)
-			i->mon = m;
+		i->mon = m;
 	}
 	w = w ? w + systrayspacing : 1;
+	systray->width = w;
+	systray->widthstale = False;
 	x -= w;
-	XMoveResizeWindow(dpy, systray->win, x, m->by, w, bh);
-	wc.x = x; wc.y = m->by; wc.width = w; wc.height = bh;
-	wc.stack_mode = Above; wc.sibling = m->barwin;
-	XConfigureWindow(dpy, systray->win, CWX|CWY|CWWidth|CWHeight|CWSibling|CWStackMode, &wc);
-	XMapWindow(dpy, systray->win);
-	XMapSubwindows(dpy, systray->win);
-	/* redraw background */
-	XSetForeground(dpy, dc.gc, dc.norm[ColBG]);
-	XFillRectangle(dpy, systray->win, dc.gc, 0, 0, w, bh);
-	XSync(dpy, False);
+	if(x != systray->x || m->by != systray->y || w != systray->w) {
+		systray->x = wc.x = x;
+		systray->y = wc.y = m->by;
+		systray->w = wc.width = w;
+		wc.height = bh;
+		wc.stack_mode = Above; wc.sibling = m->barwin;
+		XConfigureWindow(dpy, systray->win, CWX|CWY|CWWidth|CWHeight|CWSibling|CWStackMode, &wc);
+	}
+	if(systray->bg != dc.norm[ColBG]) {
+		systray->bg = dc.norm[ColBG];
+		XSetWindowBackground(dpy, systray->win, systray->bg);
+		XClearWindow(dpy, systray->win);
+		for(i = systray->icons; i; i = i->next) {
+			XSetWindowBackground(dpy, i->win, systray->bg);
+			XClearArea(dpy, i->win, 0, 0, 0, 0, True);
+		}
+	}
 }
 
 // From Xm/MwmUtil.h:
@@ -4123,7 +4702,7 @@ updatewindowtype(Client *c) {
 			c->bw = 0;
 			c->nofocus = False;
 			c->isfullscreen = True;
-			c->opacity = SPCTR;
+			c->info->opacity = SPCTR;
 			c->isbackwin = True;
 		}
 		else if(wtype == netatom[NetWMWindowTypeKDEOSD]) {
@@ -4134,6 +4713,7 @@ updatewindowtype(Client *c) {
 			c->noborder = True;
 			c->x = c->mon->mx + c->mon->mw - WIDTH(c) - c->mon->mw / 40;
 			c->y = c->mon->my + bh + c->mon->mh / 40;
+			c->isplaced = False;
 		}
 		else if(wtype == netatom[NetWMWindowTypeNotification]) {
 			c->isfloating = True;
@@ -4152,11 +4732,16 @@ updatewindowtype(Client *c) {
 		wc.border_width = c->bw;
 		XConfigureWindow(dpy, c->win, CWBorderWidth, &wc);
 	}
+	trackclient(c);
 }
 
-void
+/* returns the Hint* parts that changed */
+unsigned int
 updatewmhints(Client *c) {
 	XWMHints *wmh;
+	unsigned int changed = 0;
+	Bool urgent = c->isurgent, neverfocus = c->neverfocus;
+	Pixmap icon;
 
 	if((wmh = XGetWMHints(dpy, c->win))) {
 		if(c == selmon->sel && wmh->flags & XUrgencyHint) {
@@ -4169,8 +4754,18 @@ updatewmhints(Client *c) {
 			c->neverfocus = !wmh->input;
 		else
 			c->neverfocus = False;
+		icon = wmh->flags & IconPixmapHint ? wmh->icon_pixmap : None;
+		if(icon != c->info->icon) {
+			c->info->icon = icon;
+			changed |= HintIcon;
+		}
 		XFree(wmh);
 	}
+	if(c->isurgent != urgent)
+		changed |= HintUrgency;
+	if(c->neverfocus != neverfocus)
+		changed |= HintInput;
+	return changed;
 }
 
 void
@@ -4334,15 +4929,30 @@ void
 noop(const Arg *arg) {
 	fprintf(stderr, "NOOP\n");
 	if(selmon && selmon->sel)
-		fprintf(stderr, "selmon->sel->name: '%s'\n", selmon->sel->name);
+		fprintf(stderr, "selmon->sel->info->name: '%s'\n", clienttitle(selmon->sel));
 }
 
 int
 main(int argc, char *argv[]) {
+	const char *recordpath = NULL, *replaypath = NULL;
+	char fdarg[16];
+	int sessionfd = -1;
+
 	if(argc == 2 && !strcmp("-v", argv[1]))
 		die("dwm-"VERSION", © 2006-2012 dwm engineers, see LICENSE for details\n");
+	else if(argc == 3 && !strcmp("-r", argv[1]))
+		recordpath = argv[2];
+	else if(argc == 3 && !strcmp("-p", argv[1]))
+		replaypath = argv[2];
+	else if(argc == 3 && !strcmp("-s", argv[1]))
+		loadsession(atoi(argv[2]));
+	else if(argc == 3 && !strcmp("-g", argv[1])) {
+		readconfig();
+		writestaticconfig(argv[2], configpath());
+		return EXIT_SUCCESS;
+	}
 	else if(argc != 1)
-		die("usage: dwm [-v]\n");
+		die("usage: dwm [-v] [-r trace | -p trace | -g header]\n");
 	if(!setlocale(LC_CTYPE, "") || !XSupportsLocale())
 		fputs("warning: no locale support\n", stderr);
 	if(!(dpy = XOpenDisplay(NULL)))
@@ -4351,10 +4961,29 @@ main(int argc, char *argv[]) {
 		die("dwm: cannot get xcb connection\n");
 	checkotherwm();
 	setup();
+	restoreviews();
 	scan();
+	finishsession();
+	starttermpool();
 	startup = False;
-	run();
+	if(replaypath)
+		replay(replaypath);
+	else {
+		if(recordpath)
+			startrecording(recordpath);
+		run();
+	}
+	if(restarting)
+		sessionfd = savesession();
 	cleanup();
 	XCloseDisplay(dpy);
+	if(restarting) {
+		snprintf(fdarg, sizeof fdarg, "%d", sessionfd);
+		if(sessionfd != -1)
+			execvp(argv[0], (char *[]){ argv[0], "-s", fdarg, NULL });
+		else
+			execvp(argv[0], (char *[]){ argv[0], NULL });
+		die("dwm: cannot restart %s\n", argv[0]);
+	}
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,51 @@
+/* Focus follows the pointer after a short dwell.
+ *
+ * enternotify() only remembers the window the pointer entered and (re)arms
+ * a one-shot timerfd for focusdelay ms, polled in run(); crossing another
+ * window before it fires replaces the pending one, so sweeping over a
+ * layout focuses only the window the pointer comes to rest on. Any other
+ * focus change, like one from the keyboard, cancels the pending one. */
+static int hoverfd = -1;
+static Window hoverwin = None;
+
+void
+delayhover(Window w) {
+	struct itimerspec its = { { 0, 0 }, { focusdelay / 1000, focusdelay % 1000 * 1000000L } };
+
+	if(hoverfd == -1 && (hoverfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC)) == -1) {
+		hover(w);
+		return;
+	}
+	hoverwin = w;
+	timerfd_settime(hoverfd, 0, &its, NULL);
+}
+
+void
+cancelhover(void) {
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+
+	if(hoverwin == None)
+		return;
+	hoverwin = None;
+	timerfd_settime(hoverfd, 0, &its, NULL);
+}
+
+void
+tickhover(void) {
+	uint64_t expirations;
+	Window w = hoverwin;
+
+	if(read(hoverfd, &expirations, sizeof expirations) != sizeof expirations || w == None)
+		return;
+	hoverwin = None;
+	hover(w);
+	XFlush(dpy);
+}
+
+void
+stophover(void) {
+	if(hoverfd != -1)
+		close(hoverfd);
+	hoverfd = -1;
+	hoverwin = None;
+}
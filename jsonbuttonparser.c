@@ -18,23 +18,16 @@ static void buttonactionparser(const struct nx_json *json, Button *button) {
 	};
     int i;
 	const struct nx_json *js;
-    char *shcmd;
 
 	for (js = json->child; js; js = js->next)
         for (i = 0; i < LENGTH(parsers); ++i)
             if (!strcmp(js->key, parsers[i].key))
                 parsers[i].parse(js, button);
     if(button->arg.shcmd) {
-        if (button->arg.shcmd && argislayout(button->func)) {
-            shcmd = button->arg.shcmd;
+        if (button->arg.shcmd && argislayout(button->func))
             button->arg.v = (void*)getlayout(button->arg.shcmd);
-            free(shcmd);
-        }
-        else if (button->func == &sendselkey) {
-            shcmd = button->arg.shcmd;
-            button->arg.keysym = XStringToKeysym(shcmd);
-            free(shcmd);
-        }
+        else if (button->func == &sendselkey)
+            button->arg.keysym = XStringToKeysym(button->arg.shcmd);
     }
 }
 
@@ -93,7 +86,7 @@ static void readButtonAttribute(const struct nx_json *js, Button *button) {
 }
 
 static Button *callocbutton() {
-	Button *button = calloc(1, sizeof(Button));
+	Button *button = arenaalloc(&configarena, sizeof(Button));
 
 	return button;
 }
@@ -1,10 +1,20 @@
 #include <sys/stat.h>
+#include "arena.c"
+
+#define NX_JSON_CALLOC() arenaalloc(&parsearena, sizeof(nx_json))
+#define NX_JSON_FREE(json) ((void)(json))
 #include "nxjson.c"
 
+/* where the rules, keys, buttons and strings of the config live */
+typedef enum { ConfigArena, ConfigStatic, ConfigSnapshot } ConfigStorage;
+static ConfigStorage configstorage = ConfigArena;
+
 #include "jsonruleparser.c"
 #include "jsonparser.c"
 #include "jsonkeysparser.c"
 #include "jsonbuttonparser.c"
+#include "staticconfig.c"
+#include "configsnapshot.c"
 
 static void readRuleAttribute (const struct nx_json *js, Rule *rule) {
 	int i;
@@ -49,7 +59,7 @@ static void readRuleAttribute (const struct nx_json *js, Rule *rule) {
 }
 
 static Rule *callocrule () {
-	Rule *rule = calloc(1, sizeof(Rule));
+	Rule *rule = arenaalloc(&configarena, sizeof(Rule));
 
 	memcpy(rule, &defaultrule, sizeof(Rule));
 	return rule;
@@ -85,10 +95,11 @@ static char* load_file(const char* filepath) {
 		fprintf(stderr, "Can't open file '%s'", filepath);
 		return 0;
 	}
-	char* text=malloc(st.st_size+1); // this is not going to be freed
+	char* text=arenaalloc(&configarena, st.st_size+1);
 	if (st.st_size!=read(fd, text, st.st_size)) {
 		fprintf(stderr, "Can't read file '%s'", filepath);
 		close(fd);
+		freearena(&configarena);
 		return 0;
 	}
 	close(fd);
@@ -101,29 +112,25 @@ static void readtags (const struct nx_json *jsontags) {
 	int i;
 	struct nx_json *js;
 
-	tags = calloc(numtags + 1, sizeof(char*));
+	tags = arenaalloc(&configarena, (numtags + 1) * sizeof(char*));
 
 	for (i = 0, js = jsontags->child; js; js = js->next, ++i) {
-		tags[i] = calloc(strlen(js->text_value) + 1, sizeof(char));
-		strcpy(tags[i], js->text_value);
+		tags[i] = (char*)js->text_value;
 		if(!strcmp(tags[i], "v"))
 			vtag = 1 << i;
 	}
 }
 
 static void readfont (const struct nx_json *js) {
-	font = calloc(strlen(js->text_value) + 1, sizeof(char));
-	strcpy(font, js->text_value);
+	font = (char*)js->text_value;
 }
 
 static void readterminal (const struct nx_json *js) {
-	terminal[0] = calloc(strlen(js->text_value) + 1, sizeof(char));
-	strcpy(terminal[0], js->text_value);
+	terminal[0] = (char*)js->text_value;
 }
 
 static void readstartupscript (const struct nx_json *js) {
-	userscript = calloc(strlen(js->text_value) + 1, sizeof(char));
-	strcpy(userscript, js->text_value);
+	userscript = (char*)js->text_value;
 }
 
 static void readdockposition (const struct nx_json *js) {
@@ -143,7 +150,11 @@ static void readdockposition (const struct nx_json *js) {
 }
 
 static void readdockmonitor (const struct nx_json *js) {
-    dockmonitor = js->int_value;
+	if (js->type == NX_JSON_STRING) {
+		dockmonitorname = (char*)js->text_value;
+	}
+	else
+		dockmonitor = js->int_value;
 }
 
 static void maketagkeys(Key *key, int tagnum) {
@@ -158,7 +169,7 @@ static void maketagkeys(Key *key, int tagnum) {
 	Key *n = key;
 	Key *m = key->next;
 
-	tagkeys[tagnum] = (char*)calloc(2, sizeof(char));
+	tagkeys[tagnum] = arenaalloc(&configarena, 2);
 	tagkeys[tagnum][0] = (char)key->keysym;
 	tagkeysmod = key->mod;
 	for(int i = 0; i < LENGTH(tagkeymappings); ++i) {
@@ -177,14 +188,12 @@ static void populatetagkeys() {
 	char *tagname;
 
 	while(key) {
-		if(key->pending && !strcmp(key->pending, pendingtagkeys)) {
-			free(key->pending);
+		if(key->pending == pendingtagkeys) {
 			key->pending = NULL;
 			tagname = key->arg.shcmd;
 			for(i = 0; i < numtags; ++i) {
 				if (!strcmp(tagname, tags[i])){
 					maketagkeys(key, i);
-					free(tagname);
 					break;
 				}
 			}
@@ -195,11 +204,23 @@ static void populatetagkeys() {
 
 #define ATTRIBUTE(a) { #a, &read##a }
 
-static void readconfig () {
+static char *configpath () {
 	const char* homedir = getenv("HOME");
 	const char* relconfig = ".config/dwm/config.json";
-	char* rulesFile = calloc(strlen(homedir) + strlen(relconfig) + 2, sizeof(char));
+	char* path = calloc(strlen(homedir) + strlen(relconfig) + 2, sizeof(char));
+
+	strcpy(path, homedir);
+	strcat(path, "/");
+	strcat(path, relconfig);
+	return path;
+}
+
+static Bool readconfig () {
+	char* rulesFile = configpath();
+	char* snapFile = NULL;
 	char* content;
+	uint64_t source = 0;
+	Bool parsed = False;
 	const nx_json *json, *js;
     int att, i;
 	const struct
@@ -219,28 +240,51 @@ static void readconfig () {
 		ATTRIBUTE(buttons),
 	};
 
+#ifdef STATICCONFIG
+	if (usestaticconfig(rulesFile)) {
+		free(rulesFile);
+		return True;
+	}
+#endif
 	for(i = 0; i < LENGTH(tagkeys); ++i)
 		tagkeys[i] = NULL;
-	strcpy(rulesFile, homedir);
-	strcat(rulesFile, "/");
-	strcat(rulesFile, relconfig);
+	vtag = DEFAULT_VTAG;
+	configstorage = ConfigArena;
 
 	content = load_file(rulesFile);
 
 	if (content) {
-		json = nx_json_parse_utf8(content);
-
-		for (js = json->child; js; js = js->next) {
-            for (att = 0; att < LENGTH(readattributes); ++att)
-                if (!strcmp(js->key, readattributes[att].tagname))
-                    (*readattributes[att].read)(js);
+		source = fnv1a(FNVBASIS, content, strlen(content));
+		snapFile = snapshotpath(rulesFile);
+		if (loadsnapshot(snapFile, source)) {
+			freearena(&configarena);
+			free(snapFile);
+			free(rulesFile);
+			return True;
+		}
+		if (!(json = nx_json_parse_utf8(content))) {
+			fprintf(stderr, "dwm: cannot parse %s\n", rulesFile);
+			freearena(&parsearena);
+			free(snapFile);
+			snapFile = NULL;
+		}
+		else {
+			for (js = json->child; js; js = js->next) {
+				for (att = 0; att < LENGTH(readattributes); ++att)
+					if (!strcmp(js->key, readattributes[att].tagname))
+						(*readattributes[att].read)(js);
+			}
+			freearena(&parsearena);
+			parsed = True;
 		}
-		nx_json_free(json);
-		free(content);
-	}
-	if (!font) {
-		font = calloc(strlen(fallbackfont) + 1, sizeof(char));
-		strcpy(font, fallbackfont);
 	}
+	if (!font)
+		font = arenastrdup(&configarena, fallbackfont);
 	populatetagkeys();
+	if (snapFile) {
+		writesnapshot(snapFile, source);
+		free(snapFile);
+	}
+	free(rulesFile);
+	return parsed;
 }
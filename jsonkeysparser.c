@@ -11,10 +11,8 @@ static void keyparser(const struct nx_json *json, Key *key) {
 }
 
 static void keyfunctionparser(const struct nx_json *json, Key *key) {
-	if(!strcmp(json->text_value, pendingtagkeys)) {
-		key->pending = calloc(strlen(pendingtagkeys) + 1, sizeof(char));
-		strcpy(key->pending, pendingtagkeys);
-	}
+	if(!strcmp(json->text_value, pendingtagkeys))
+		key->pending = pendingtagkeys;
 	else
 		key->func = texttofunction(json->text_value);
 }
@@ -35,17 +33,13 @@ static void keyactionparser(const struct nx_json *json, Key *key) {
 	};
 	int i;
 	const struct nx_json *js;
-	char *shcmd;
 
 	for (js = json->child; js; js = js->next)
 		for (i = 0; i < LENGTH(parsers); ++i)
 			if (!strcmp(js->key, parsers[i].key))
 				parsers[i].parse(js, key);
-	if(key->arg.shcmd && argislayout(key->func)) {
-		shcmd = key->arg.shcmd;
+	if(key->arg.shcmd && argislayout(key->func))
 		key->arg.v = (void*)getlayout(key->arg.shcmd);
-		free(shcmd);
-	}
 }
 
 static void readKeyAttribute(const struct nx_json *js, Key *key) {
@@ -69,7 +63,7 @@ static void readKeyAttribute(const struct nx_json *js, Key *key) {
 }
 
 static Key *callockey() {
-	Key *key = calloc(1, sizeof(Key));
+	Key *key = arenaalloc(&configarena, sizeof(Key));
 
 	return key;
 }
@@ -2,53 +2,56 @@
 
 typedef void (*ArgFunction)(const Arg*);
 
-static ArgFunction texttofunction(const char *name) {
 #define FUNC(fun) { #fun, fun }
-	const struct
-	{
-		const char *name;
-		ArgFunction func;
-	}
-	actions[] = {
-		FUNC(allnonfloat),
-		FUNC(decreasebright),
-		FUNC(focuslast),
-		FUNC(focusmon),
-		FUNC(focusstack),
-		FUNC(increasebright),
-		FUNC(killclient),
-		FUNC(mirrorlayout),
-		FUNC(movemouse),
-		FUNC(opacitychange),
-		FUNC(pushdown),
-		FUNC(pushup),
-		FUNC(quit),
-		FUNC(resizemouse),
-		FUNC(rotatelayoutaxis),
-		FUNC(rotatemonitor),
-		FUNC(sendselkey),
-		FUNC(setlayout),
-		FUNC(setmfact),
-		FUNC(shiftmastersplit),
-		FUNC(spawn),
-		FUNC(spawnterm),
-		FUNC(tabview),
-		FUNC(tag),
-		FUNC(tagmon),
-		FUNC(togglebar),
-		FUNC(toggledock),
-		FUNC(togglefloating),
-		FUNC(togglefoldtags),
-		FUNC(toggletag),
-		FUNC(togglevarilayout),
-		FUNC(toggleview),
-		FUNC(togglewindowgap),
-		FUNC(updatecolors),
-		FUNC(view),
-		FUNC(viewscroll),
-		FUNC(zoom),
-		FUNC(noop),
-	};
+static const struct
+{
+	const char *name;
+	ArgFunction func;
+}
+actions[] = {
+	FUNC(allnonfloat),
+	FUNC(decreasebright),
+	FUNC(focuslast),
+	FUNC(focusmon),
+	FUNC(focusstack),
+	FUNC(increasebright),
+	FUNC(killclient),
+	FUNC(mirrorlayout),
+	FUNC(movemouse),
+	FUNC(opacitychange),
+	FUNC(pushdown),
+	FUNC(pushup),
+	FUNC(quit),
+	FUNC(reloadconfig),
+	FUNC(resizemouse),
+	FUNC(restart),
+	FUNC(rotatelayoutaxis),
+	FUNC(rotatemonitor),
+	FUNC(sendselkey),
+	FUNC(setlayout),
+	FUNC(setmfact),
+	FUNC(shiftmastersplit),
+	FUNC(spawn),
+	FUNC(spawnterm),
+	FUNC(tabview),
+	FUNC(tag),
+	FUNC(tagmon),
+	FUNC(togglebar),
+	FUNC(toggledock),
+	FUNC(togglefloating),
+	FUNC(togglefoldtags),
+	FUNC(toggletag),
+	FUNC(togglevarilayout),
+	FUNC(toggleview),
+	FUNC(togglewindowgap),
+	FUNC(updatecolors),
+	FUNC(view),
+	FUNC(viewscroll),
+	FUNC(zoom),
+	FUNC(noop),
+};
+
+static ArgFunction texttofunction(const char *name) {
 	int i;
 	ArgFunction func = NULL;
 
@@ -60,6 +63,15 @@ static ArgFunction texttofunction(const char *name) {
 	return func;
 }
 
+static const char *functiontotext(ArgFunction func) {
+	int i;
+
+	for(i = 0; i < LENGTH(actions); ++i)
+		if (actions[i].func == func)
+			return actions[i].name;
+	return NULL;
+}
+
 static unsigned int jsontomodifier(const struct nx_json *json) {
 #define MODIFIER(mod) { #mod, mod ## Mask }
 	const struct
@@ -114,8 +126,7 @@ static const Layout *getlayout(const char *name) {
 static void argparser(const struct nx_json *json, Arg *arg) {
 	switch(json->type) {
 	case NX_JSON_STRING:
-		arg->shcmd = calloc(strlen(json->text_value) + 1, sizeof(char));
-		strcpy(arg->shcmd, json->text_value);
+		arg->shcmd = (char*)json->text_value;
 		break;
 	case NX_JSON_DOUBLE:
 		arg->f = (float)json->dbl_value;
@@ -147,3 +158,20 @@ static Bool argislayout(void (*func)(const Arg *)) {
 			needslayout = True;
 	return needslayout;
 }
+
+/* which Arg member a parsed action filled, the parsers go by the function */
+enum { ArgInt, ArgUint, ArgFloat, ArgKeysym, ArgLayout, ArgShcmd };
+
+static int argkind(ArgFunction func, Bool isbutton) {
+	if(func == spawn || (func == sendselkey && !isbutton))
+		return ArgShcmd;
+	if(argislayout(func))
+		return ArgLayout;
+	if(func == sendselkey)
+		return ArgKeysym;
+	if(func == setmfact || func == opacitychange)
+		return ArgFloat;
+	if(func == view || func == toggleview || func == tag || func == toggletag)
+		return ArgUint;
+	return ArgInt;
+}
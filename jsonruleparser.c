@@ -1,23 +1,17 @@
-static void copystring (char** pstr, const struct nx_json *js) {
-	int length = strlen(js->text_value);
-
-	*pstr = calloc(length + 1, sizeof(char));
-	if (*js->text_value)
-		strncpy(*pstr, js->text_value, length);
-	else
-		**pstr = 0;
+static void pointstring (char** pstr, const struct nx_json *js) {
+	*pstr = (char*)js->text_value;
 }
 
 static void classparser (const struct nx_json *js, Rule *rule) {
-	copystring(&rule->class, js);
+	pointstring(&rule->class, js);
 }
 
 static void instanceparser (const struct nx_json *js, Rule *rule) {
-	copystring(&rule->instance, js);
+	pointstring(&rule->instance, js);
 }
 
 static void titleparser (const struct nx_json *js, Rule *rule) {
-	copystring(&rule->title, js);
+	pointstring(&rule->title, js);
 }
 
 static void tagparser (const struct nx_json *js, Rule *rule) {
@@ -68,7 +62,10 @@ static void rhparser (const struct nx_json *js, Rule *rule) {
 }
 
 static void monitorparser (const struct nx_json *js, Rule *rule) {
-	rule->monitor = js->int_value;
+	if (js->type == NX_JSON_STRING)
+		pointstring(&rule->monitorname, js);
+	else
+		rule->monitor = js->int_value;
 }
 
 static void remapparser (const struct nx_json *js, Rule *rule) {
@@ -100,7 +97,7 @@ static void istransientparser (const struct nx_json *js, Rule *rule) {
 }
 
 static void procnameparser (const struct nx_json *js, Rule *rule) {
-	copystring(&rule->procname, js);
+	pointstring(&rule->procname, js);
 }
 
 static void isfullscreenparser (const struct nx_json *js, Rule *rule) {
@@ -48,8 +48,8 @@ opacitychange(const Arg *arg) {
 
 	if (selmon->sel)
 	{
-		opacity = selmon->sel->opacity;
-		selmon->sel->opacity = MAX(0.1, MIN(1, opacity + arg->f));
+		opacity = selmon->sel->info->opacity;
+		selmon->sel->info->opacity = MAX(0.1, MIN(1, opacity + arg->f));
 		setclientopacity(selmon->sel);
 	}
 }
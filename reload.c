@@ -0,0 +1,269 @@
+/* Config reload.
+ *
+ * reloadconfig (bound to a key) and SIGHUP only flag a reload; run() calls
+ * swapconfig() between events, as the key and button handlers are still
+ * walking lists of the current generation, and SIGHUP wakes it through a
+ * pipe. It reads config.json into a new
+ * generation while the current one is parked, and only swaps when the new
+ * one parsed and has a usable tag list; otherwise the parked generation is
+ * put back untouched. After the swap clients and views are carried over to
+ * the new tags by name (or by position for renamed tags), key grabs are
+ * changed only for bindings that appeared or disappeared, and the old
+ * generation is freed in one go. The font is only read at startup. */
+typedef struct {
+	Rule *rules;
+	Key *keys;
+	Button *buttons;
+	char **tags;
+	int numtags;
+	unsigned int vtag;
+	char *tagkeys[LENGTH(tagkeys)];
+	unsigned int tagkeysmod;
+	char *font, *terminal, *userscript, *dockmonitorname;
+	ScreenSide dockposition;
+	int dockmonitor;
+	ConfigStorage storage;
+	Arena arena;
+	char *snapbase;
+	size_t snapsize;
+} ConfigGeneration;
+
+static volatile sig_atomic_t reloadpending = 0;
+static int reloadpipe[2] = { -1, -1 };  /* wakes run() from poll() on SIGHUP */
+
+static void
+parkconfig(ConfigGeneration *g) {
+	int i;
+
+	g->rules = rules;
+	g->keys = keys;
+	g->buttons = buttons;
+	g->tags = tags;
+	g->numtags = numtags;
+	g->vtag = vtag;
+	for(i = 0; i < LENGTH(tagkeys); ++i)
+		g->tagkeys[i] = tagkeys[i];
+	g->tagkeysmod = tagkeysmod;
+	g->font = font;
+	g->terminal = terminal[0];
+	g->userscript = userscript;
+	g->dockmonitorname = dockmonitorname;
+	g->dockposition = dockposition;
+	g->dockmonitor = dockmonitor;
+	g->storage = configstorage;
+	g->arena = configarena;
+	g->snapbase = snapbase;
+	g->snapsize = snapsize;
+
+	rules = NULL;
+	keys = NULL;
+	buttons = NULL;
+	tags = NULL;
+	numtags = 0;
+	font = terminal[0] = userscript = dockmonitorname = NULL;
+	dockposition = DEFAULT_DOCKPOSITION;
+	dockmonitor = DEFAULT_DOCKMONITOR;
+	configarena.blocks = NULL;
+	snapbase = NULL;
+}
+
+static void
+restoreconfig(const ConfigGeneration *g) {
+	int i;
+
+	rules = g->rules;
+	keys = g->keys;
+	buttons = g->buttons;
+	tags = g->tags;
+	numtags = g->numtags;
+	vtag = g->vtag;
+	for(i = 0; i < LENGTH(tagkeys); ++i)
+		tagkeys[i] = g->tagkeys[i];
+	tagkeysmod = g->tagkeysmod;
+	font = g->font;
+	terminal[0] = g->terminal;
+	userscript = g->userscript;
+	dockmonitorname = g->dockmonitorname;
+	dockposition = g->dockposition;
+	dockmonitor = g->dockmonitor;
+	configstorage = g->storage;
+	configarena = g->arena;
+	snapbase = g->snapbase;
+	snapsize = g->snapsize;
+}
+
+static void
+freegeneration(ConfigGeneration *g) {
+	if(g->storage == ConfigSnapshot && g->snapbase)
+		munmap(g->snapbase, g->snapsize);
+	freearena(&g->arena);
+}
+
+static Bool
+keybound(const Key *list, unsigned int mod, KeySym keysym) {
+	for(; list; list = list->next)
+		if(list->mod == mod && list->keysym == keysym)
+			return True;
+	return False;
+}
+
+/* grab keys that are new in keys, ungrab those that only were in oldkeys */
+static void
+regrabkeys(Window window, const Key *oldkeys) {
+	unsigned int j;
+	unsigned int modifiers[] = { 0, LockMask, numlockmask, numlockmask|LockMask };
+	const Key *key;
+	KeyCode code;
+
+	for(key = oldkeys; key; key = key->next)
+		if(!keybound(keys, key->mod, key->keysym) && (code = XKeysymToKeycode(dpy, key->keysym)))
+			for(j = 0; j < LENGTH(modifiers); j++)
+				XUngrabKey(dpy, code, key->mod | modifiers[j], window);
+	for(key = keys; key; key = key->next)
+		if(!keybound(oldkeys, key->mod, key->keysym) && (code = XKeysymToKeycode(dpy, key->keysym)))
+			for(j = 0; j < LENGTH(modifiers); j++)
+				XGrabKey(dpy, code, key->mod | modifiers[j], window,
+						True, GrabModeAsync, GrabModeAsync);
+}
+
+static Bool
+samebuttons(const Button *a, const Button *b) {
+	for(; a && b; a = a->next, b = b->next)
+		if(a->click != b->click || a->mask != b->mask || a->button != b->button)
+			return False;
+	return !a && !b;
+}
+
+static unsigned int
+remaptags(unsigned int t, const int *map, const ConfigGeneration *old) {
+	unsigned int r = 0;
+	int i;
+
+	if(t == ~0U)
+		return t;
+	if(t == (1U << old->numtags) - 1)
+		return TAGMASK;
+	for(i = 0; i < old->numtags; ++i)
+		if(t & 1 << i && map[i] >= 0)
+			r |= 1 << map[i];
+	return r;
+}
+
+static void
+remapviews(Monitor *m, const int *map, const ConfigGeneration *old) {
+	ViewStack **pv, *v, *w;
+	unsigned int t;
+
+	for(pv = &m->vs; (v = *pv);) {
+		t = remaptags(v->tagset, map, old);
+		for(w = m->vs; w != v && w->tagset != t; w = w->next);
+		if(v != m->vs && (!t || w != v)) {
+			*pv = v->next;
+			free(v);
+			continue;
+		}
+		v->tagset = t ? t : 1;
+		pv = &v->next;
+	}
+}
+
+static void
+swaptags(const ConfigGeneration *old) {
+	int map[LENGTH(tagkeys)];
+	Bool taken[LENGTH(tagkeys)] = { False };
+	Monitor *m;
+	Client *c;
+	int i, j;
+
+	for(i = 0; i < old->numtags; ++i) {
+		for(j = 0; j < numtags && strcmp(old->tags[i], tags[j]); ++j);
+		map[i] = j < numtags ? j : -1;
+		if(map[i] >= 0)
+			taken[map[i]] = True;
+	}
+	for(i = 0; i < old->numtags; ++i)
+		if(map[i] < 0 && i < numtags && !taken[i])
+			map[i] = i;
+	for(m = mons; m; m = m->next) {
+		remapviews(m, map, old);
+		for(c = m->clients; c; c = c->next) {
+			if(!(c->tags = remaptags(c->tags, map, old)))
+				c->tags = m->vs->tagset;
+			updateclientdesktop(c);
+		}
+	}
+	setnumdesktops();
+	setdesktopnames();
+}
+
+void
+swapconfig(void) {
+	ConfigGeneration old;
+	Monitor *m;
+	Client *c;
+
+	parkconfig(&old);
+	if(!readconfig() || !tags || numtags < 1 || numtags > LENGTH(tagkeys)) {
+		fprintf(stderr, "dwm: keeping the current config\n");
+		if(configstorage == ConfigSnapshot)
+			freesnapshot();
+		freearena(&configarena);
+		restoreconfig(&old);
+		return;
+	}
+	swaptags(&old);
+	updatenumlockmask();
+	regrabkeys(root, old.keys);
+	for(m = mons; m; m = m->next)
+		for(c = m->clients; c; c = c->next) {
+			regrabkeys(c->win, old.keys);
+			if(!samebuttons(buttons, old.buttons))
+				grabbuttons(c, c == selmon->sel);
+		}
+	/* pooled terminals run the old command */
+	if(!old.terminal != !terminal[0] || (old.terminal && strcmp(old.terminal, terminal[0]))) {
+		stoptermpool();
+		starttermpool();
+	}
+	freegeneration(&old);
+	focus(NULL);
+	arrange(NULL);
+}
+
+void
+reloadconfig(const Arg *arg) {
+	reloadpending = 1;
+}
+
+static void
+sighup(int unused) {
+	int e = errno;
+
+	if(signal(SIGHUP, sighup) == SIG_ERR)
+		die("Can't install SIGHUP handler");
+	reloadpending = 1;
+	if(reloadpipe[1] != -1)
+		write(reloadpipe[1], "", 1);
+	errno = e;
+}
+
+void
+startreload(void) {
+	int i;
+
+	if(pipe(reloadpipe) == -1)
+		reloadpipe[0] = reloadpipe[1] = -1;
+	for(i = 0; i < 2 && reloadpipe[i] != -1; ++i) {
+		fcntl(reloadpipe[i], F_SETFL, O_NONBLOCK);
+		fcntl(reloadpipe[i], F_SETFD, FD_CLOEXEC);
+	}
+	sighup(0);
+	reloadpending = 0;
+}
+
+void
+tickreload(void) {
+	char buf[64];
+
+	while(read(reloadpipe[0], buf, sizeof buf) > 0);
+}
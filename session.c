@@ -0,0 +1,348 @@
+/* Session handoff across restarts.
+ *
+ * The restart key function stops the event loop; before cleanup() unmanages
+ * everything, main() writes the session (monitors with their view stacks,
+ * and selection, and every client with its tags, floating
+ * geometry, fullscreen state with the geometry to go back to, rule-derived
+ * flags and place in the client and focus lists) to
+ * an unlinked file on /dev/shm and re-executes dwm with -s <fd>. The new
+ * instance reads it back after setup(): view stacks are replaced before
+ * scan(), manage() takes known windows from the session instead of running
+ * applyrules(), and list order, selection and focus are put back afterwards.
+ * Windows the session does not know go through the rules as usual. */
+#define SESSIONMAGIC "dwm-session 3"
+
+typedef struct {
+	Window win;
+	int mon;
+	unsigned int tags;
+	int x, y, w, h;
+	int isfloating, exfocus, noborder, isterminal, picomfreeze, rh;
+	double opacity;
+	int remap;
+	int order, stackorder;
+	unsigned int isfullscreen;  /* tags before going fullscreen */
+	int oldx, oldy, oldw, oldh, oldbw, oldstate, isfixed;
+	Bool restored;
+} SessionClient;
+
+typedef struct {
+	int num;
+	Window sel;
+	ViewStack *vs;
+} SessionMonitor;
+
+typedef struct {
+	char *data;
+	size_t len, size;
+} SessionBuf;
+
+static Bool restarting = False;
+static SessionClient *sessionclients = NULL;
+static int nsessionclients = 0;
+static SessionMonitor *sessionmons = NULL;
+static int nsessionmons = 0;
+static int sessionselmon = -1;
+
+void
+restart(const Arg *arg) {
+	restarting = True;
+	running = False;
+}
+
+static void
+sessionprintf(SessionBuf *b, const char *fmt, ...) {
+	va_list ap;
+	int n;
+
+	for(;;) {
+		va_start(ap, fmt);
+		n = vsnprintf(b->data + b->len, b->size - b->len, fmt, ap);
+		va_end(ap);
+		if(n < 0)
+			return;
+		if(b->len + n < b->size) {
+			b->len += n;
+			return;
+		}
+		b->size = MAX(b->size * 2, b->len + n + 1024);
+		if(!(b->data = realloc(b->data, b->size)))
+			die("fatal: could not malloc() %u bytes\n", b->size);
+	}
+}
+
+static int
+sessionremapindex(const Remap *remap) {
+	int i;
+
+	for(i = 0; remap && i < LENGTH(remaps); ++i)
+		if(remaps[i].remap == remap)
+			return i;
+	return -1;
+}
+
+/* returns an fd left open across exec, or -1 */
+static int
+savesession(void) {
+	const char *dirs[] = { "/dev/shm", "/tmp" };
+	SessionBuf b = { NULL, 0, 0 };
+	char path[64];
+	Monitor *m;
+	Client *c, *s;
+	ViewStack *v;
+	int fd = -1, i, order, stackorder;
+	size_t off;
+	ssize_t n;
+
+	sessionprintf(&b, "%s\n", SESSIONMAGIC);
+	for(m = mons; m; m = m->next) {
+		sessionprintf(&b, "m %d %d %lu\n", m->num, m == selmon, m->sel ? m->sel->win : 0);
+		for(v = m->vs; v; v = v->next)
+			sessionprintf(&b, "v %d %u %d %d %d %d %d %.9g %u %d %d %d\n", m->num, v->tagset,
+			              v->curlt, (int)(v->lt[0] - layouts), (int)(v->lt[1] - layouts),
+			              v->showbar, v->showdock, v->mfact, v->msplit,
+			              v->ltaxis[0], v->ltaxis[1], v->ltaxis[2]);
+		for(c = m->clients, order = 0; c; c = c->next, ++order) {
+			for(s = m->stack, stackorder = 0; s && s != c; s = s->snext, ++stackorder);
+			sessionprintf(&b, "c %lu %d %u %d %d %d %d %d %d %d %d %d %d %.17g %d %d %d"
+			              " %u %d %d %d %d %d %d %d\n",
+			              c->win, m->num, c->tags, c->x, c->y, c->w, c->h,
+			              c->isfloating, c->exfocus, c->noborder, c->isterminal,
+			              c->picomfreeze, c->rh, c->info->opacity,
+			              sessionremapindex(c->info->remap), order, stackorder,
+			              c->isfullscreen, c->oldx, c->oldy, c->oldw, c->oldh, c->oldbw,
+			              c->oldstate, c->isfixed);
+		}
+	}
+	for(i = 0; fd == -1 && i < LENGTH(dirs); ++i) {
+		snprintf(path, sizeof path, "%s/dwm-session-%d", dirs[i], (int)getpid());
+		fd = open(path, O_RDWR|O_CREAT|O_EXCL, 0600);
+	}
+	if(fd != -1) {
+		unlink(path);
+		for(off = 0; off < b.len; off += n)
+			if((n = write(fd, b.data + off, b.len - off)) <= 0) {
+				close(fd);
+				fd = -1;
+				break;
+			}
+	}
+	if(fd == -1)
+		fprintf(stderr, "dwm: cannot save the session, restarting without it\n");
+	free(b.data);
+	return fd;
+}
+
+static void
+loadsession(int fd) {
+	SessionMonitor *sm;
+	SessionClient sc;
+	ViewStack v, *nv, **tail;
+	struct stat st;
+	char *data, *line, *next;
+	int num, sel, curlt, lt0, lt1, showbar, showdock;
+	unsigned long selwin, win;
+	ssize_t n;
+	size_t len;
+
+	if(fstat(fd, &st) || lseek(fd, 0, SEEK_SET) == -1
+	|| !(data = malloc(st.st_size + 1))) {
+		close(fd);
+		return;
+	}
+	for(len = 0; len < st.st_size && (n = read(fd, data + len, st.st_size - len)) > 0; len += n);
+	close(fd);
+	data[len] = '\0';
+	if(strncmp(data, SESSIONMAGIC "\n", sizeof(SESSIONMAGIC))) {
+		fprintf(stderr, "dwm: ignoring unknown session format\n");
+		free(data);
+		return;
+	}
+	for(line = data + sizeof(SESSIONMAGIC); *line; line = next) {
+		if((next = strchr(line, '\n')))
+			*next++ = '\0';
+		else
+			next = line + strlen(line);
+		if(sscanf(line, "m %d %d %lu", &num, &sel, &selwin) == 3) {
+			if(!(sessionmons = realloc(sessionmons, (nsessionmons + 1) * sizeof(SessionMonitor))))
+				die("fatal: could not malloc() %u bytes\n", (nsessionmons + 1) * sizeof(SessionMonitor));
+			sm = &sessionmons[nsessionmons++];
+			sm->num = num;
+			sm->sel = selwin;
+			sm->vs = NULL;
+			if(sel)
+				sessionselmon = num;
+		}
+		else if(nsessionmons && sscanf(line, "v %d %u %d %d %d %d %d %f %u %d %d %d", &num,
+		        &v.tagset, &curlt, &lt0, &lt1, &showbar, &showdock, &v.mfact, &v.msplit,
+		        &v.ltaxis[0], &v.ltaxis[1], &v.ltaxis[2]) == 12) {
+			sm = &sessionmons[nsessionmons - 1];
+			if(num != sm->num || curlt < 0 || curlt > 1 || lt0 < 0 || lt0 >= LENGTH(layouts)
+			|| lt1 < 0 || lt1 >= LENGTH(layouts))
+				continue;
+			if(!(nv = (ViewStack *)calloc(1, sizeof(ViewStack))))
+				die("fatal: could not malloc() %u bytes\n", sizeof(ViewStack));
+			*nv = v;
+			nv->curlt = curlt;
+			nv->lt[0] = &layouts[lt0];
+			nv->lt[1] = &layouts[lt1];
+			nv->showbar = showbar != 0;
+			nv->showdock = showdock != 0;
+			nv->next = NULL;
+			for(tail = &sm->vs; *tail; tail = &(*tail)->next);
+			*tail = nv;
+		}
+		else if(sscanf(line, "c %lu %d %u %d %d %d %d %d %d %d %d %d %d %lf %d %d %d"
+		        " %u %d %d %d %d %d %d %d", &win,
+		        &sc.mon, &sc.tags, &sc.x, &sc.y, &sc.w, &sc.h, &sc.isfloating, &sc.exfocus,
+		        &sc.noborder, &sc.isterminal, &sc.picomfreeze, &sc.rh, &sc.opacity,
+		        &sc.remap, &sc.order, &sc.stackorder, &sc.isfullscreen, &sc.oldx, &sc.oldy,
+		        &sc.oldw, &sc.oldh, &sc.oldbw, &sc.oldstate, &sc.isfixed) == 25) {
+			if(!(sessionclients = realloc(sessionclients, (nsessionclients + 1) * sizeof(SessionClient))))
+				die("fatal: could not malloc() %u bytes\n", (nsessionclients + 1) * sizeof(SessionClient));
+			sc.win = win;
+			sc.restored = False;
+			sessionclients[nsessionclients++] = sc;
+		}
+	}
+	free(data);
+}
+
+static SessionMonitor *
+sessionmonitor(int num) {
+	int i;
+
+	for(i = 0; i < nsessionmons; ++i)
+		if(sessionmons[i].num == num)
+			return &sessionmons[i];
+	return NULL;
+}
+
+static SessionClient *
+sessionclient(Window w) {
+	int i;
+
+	for(i = 0; i < nsessionclients; ++i)
+		if(sessionclients[i].win == w)
+			return &sessionclients[i];
+	return NULL;
+}
+
+/* called between setup() and scan() */
+static void
+restoreviews(void) {
+	SessionMonitor *sm;
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		if((sm = sessionmonitor(m->num)) && sm->vs) {
+			cleanupviewstack(m->vs);
+			m->vs = sm->vs;
+			sm->vs = NULL;
+		}
+}
+
+/* takes the place of applyrules() for windows the session knows */
+static Bool
+restoreclient(Client *c) {
+	SessionClient *sc;
+	Monitor *m;
+
+	if(!nsessionclients || !(sc = sessionclient(c->win)) || !(sc->tags & TAGMASK))
+		return False;
+	for(m = mons; m && m->num != sc->mon; m = m->next);
+	if(m)
+		c->mon = m;
+	c->tags = sc->tags & TAGMASK;
+	c->isfloating = sc->isfloating != 0;
+	c->exfocus = sc->exfocus != 0;
+	c->noborder = sc->noborder != 0;
+	c->isterminal = sc->isterminal != 0;
+	c->picomfreeze = sc->picomfreeze != 0;
+	c->rh = sc->rh != 0;
+	c->info->opacity = sc->opacity;
+	if(sc->remap >= 0 && sc->remap < LENGTH(remaps))
+		c->info->remap = remaps[sc->remap].remap;
+	c->isfixed = sc->isfixed != 0;
+	c->oldstate = sc->oldstate != 0;
+	c->oldbw = sc->oldbw;
+	if((c->isfullscreen = sc->isfullscreen & TAGMASK)) {
+		/* setfullscreen(), called from updatewindowtype(), keeps these
+		 * as the geometry to go back to */
+		c->x = c->oldx = sc->oldx;
+		c->y = c->oldy = sc->oldy;
+		c->w = c->oldw = sc->oldw;
+		c->h = c->oldh = sc->oldh;
+	}
+	else if(c->isfloating) {
+		c->x = c->oldx = sc->x;
+		c->y = c->oldy = sc->y;
+		c->w = c->oldw = sc->w;
+		c->h = c->oldh = sc->h;
+	}
+	sc->restored = True;
+	trackclient(c);
+	return True;
+}
+
+static int
+sessionorder(const Client *c, Bool stack) {
+	SessionClient *sc = sessionclient(c->win);
+
+	if(!sc || !sc->restored)
+		return -1;
+	return stack ? sc->stackorder : sc->order;
+}
+
+/* new windows first, then the saved order */
+static void
+sortclients(Monitor *m, Bool stack) {
+	Client *sorted = NULL, *c, **pc;
+
+	while((c = stack ? m->stack : m->clients)) {
+		if(stack)
+			m->stack = c->snext;
+		else
+			m->clients = c->next;
+		for(pc = &sorted; *pc && sessionorder(*pc, stack) <= sessionorder(c, stack);
+		    pc = stack ? &(*pc)->snext : &(*pc)->next);
+		if(stack)
+			c->snext = *pc;
+		else
+			c->next = *pc;
+		*pc = c;
+	}
+	if(stack)
+		m->stack = sorted;
+	else
+		m->clients = sorted;
+}
+
+/* called after scan() */
+static void
+finishsession(void) {
+	SessionMonitor *sm;
+	Monitor *m;
+	Client *c;
+	int i;
+
+	if(!nsessionmons && !nsessionclients)
+		return;
+	for(m = mons; m; m = m->next) {
+		sortclients(m, False);
+		sortclients(m, True);
+		if((sm = sessionmonitor(m->num)) && (c = wintoclient(sm->sel)) && c->mon == m)
+			m->sel = c;
+		if(m->num == sessionselmon)
+			selmon = m;
+	}
+	for(i = 0; i < nsessionmons; ++i)
+		cleanupviewstack(sessionmons[i].vs);
+	free(sessionmons);
+	free(sessionclients);
+	sessionmons = NULL;
+	sessionclients = NULL;
+	nsessionmons = nsessionclients = 0;
+	focus(selmon->sel);
+	arrange(NULL);
+}
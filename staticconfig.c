@@ -0,0 +1,222 @@
+/* Built-in configuration.
+ *
+ * dwm -g <file> reads config.json the usual way and writes the result out as
+ * C tables, with functions, layouts, remaps and keysyms already resolved.
+ * Building with -DSTATICCONFIG (make static) compiles those tables in, so
+ * startup neither parses JSON nor allocates any of the config. config.json is
+ * still parsed when it changed after the tables were generated. */
+#ifdef STATICCONFIG
+#include "staticconfig.h"
+
+static Bool
+usestaticconfig(const char *path) {
+	struct stat st;
+	int i;
+
+	if(!stat(path, &st) && (st.st_mtime != staticconfigmtime || st.st_size != staticconfigsize)) {
+		fprintf(stderr, "dwm: %s changed since the build, reading it instead\n", path);
+		return False;
+	}
+	rules = staticrulelist;
+	keys = statickeylist;
+	buttons = staticbuttonlist;
+	tags = statictags;
+	numtags = LENGTH(statictags) - 1;
+	vtag = staticvtag;
+	for(i = 0; i < LENGTH(tagkeys); ++i)
+		tagkeys[i] = statictagkeys[i];
+	tagkeysmod = statictagkeysmod;
+	font = staticfont;
+	terminal[0] = staticterminal;
+	userscript = staticuserscript;
+	dockposition = staticdockposition;
+	dockmonitor = staticdockmonitor;
+	dockmonitorname = staticdockmonitorname;
+	configstorage = ConfigStatic;
+	return True;
+}
+#endif /* STATICCONFIG */
+
+static void
+writecstring(FILE *f, const char *s) {
+	if(!s) {
+		fputs("NULL", f);
+		return;
+	}
+	fputc('"', f);
+	for(; *s; ++s)
+		if(*s == '"' || *s == '\\')
+			fprintf(f, "\\%c", *s);
+		else if((unsigned char)*s < ' ')
+			fprintf(f, "\\%03o", (unsigned char)*s);
+		else
+			fputc(*s, f);
+	fputc('"', f);
+}
+
+static void
+writefunction(FILE *f, ArgFunction func) {
+	const char *name = func ? functiontotext(func) : NULL;
+
+	fputs(name ? name : "NULL", f);
+}
+
+static void
+writelayout(FILE *f, const Layout *l) {
+	if(l)
+		fprintf(f, "&layouts[%d]", (int)(l - layouts));
+	else
+		fputs("NULL", f);
+}
+
+static void
+writeremap(FILE *f, const Remap *remap) {
+	int i;
+
+	for(i = 0; i < LENGTH(remaps); ++i)
+		if(remaps[i].remap == remap) {
+			fputs(remaps[i].name, f);
+			return;
+		}
+	fputs("NULL", f);
+}
+
+static void
+writearg(FILE *f, ArgFunction func, const Arg *arg, Bool isbutton) {
+	switch(argkind(func, isbutton)) {
+	case ArgShcmd:
+		fputs("{ .shcmd = ", f);
+		writecstring(f, arg->shcmd);
+		break;
+	case ArgLayout:
+		fputs("{ .v = ", f);
+		writelayout(f, (const Layout *)arg->v);
+		break;
+	case ArgKeysym:
+		fprintf(f, "{ .keysym = 0x%lx", arg->keysym);
+		break;
+	case ArgFloat:
+		fprintf(f, "{ .f = (float)%.9g", arg->f);
+		break;
+	case ArgUint:
+		fprintf(f, "{ .ui = 0x%x", arg->ui);
+		break;
+	default:
+		fprintf(f, "{ .i = %d", arg->i);
+		break;
+	}
+	fputs(" }", f);
+}
+
+static void
+writestaticconfig(const char *out, const char *src) {
+	FILE *f;
+	struct stat st;
+	const Rule *r;
+	const Key *k;
+	const Button *b;
+	int i;
+
+	if(!(f = fopen(out, "w")))
+		die("dwm: cannot write %s\n", out);
+	if(stat(src, &st))
+		st.st_mtime = st.st_size = 0;
+	fprintf(f, "/* generated by dwm -g from %s, do not edit */\n", src);
+	fprintf(f, "static const time_t staticconfigmtime = %lld;\n", (long long)st.st_mtime);
+	fprintf(f, "static const off_t staticconfigsize = %lld;\n\n", (long long)st.st_size);
+
+	fputs("static char *statictags[] = { ", f);
+	for(i = 0; i < numtags; ++i) {
+		writecstring(f, tags[i]);
+		fputs(", ", f);
+	}
+	fputs("NULL };\n", f);
+	fprintf(f, "static const unsigned int staticvtag = 0x%x;\n", vtag);
+	fprintf(f, "static char *statictagkeys[%d] = { ", (int)LENGTH(tagkeys));
+	for(i = 0; i < LENGTH(tagkeys); ++i) {
+		writecstring(f, tagkeys[i]);
+		fputs(i < LENGTH(tagkeys) - 1 ? ", " : " };\n", f);
+	}
+	fprintf(f, "static const unsigned int statictagkeysmod = 0x%x;\n", tagkeysmod);
+	fputs("static char *staticfont = ", f);
+	writecstring(f, font);
+	fputs(";\nstatic char *staticterminal = ", f);
+	writecstring(f, terminal[0]);
+	fputs(";\nstatic char *staticuserscript = ", f);
+	writecstring(f, userscript);
+	fprintf(f, ";\nstatic const ScreenSide staticdockposition = %d;\n", (int)dockposition);
+	fprintf(f, "static const int staticdockmonitor = %d;\n", dockmonitor);
+	fputs("static char *staticdockmonitorname = ", f);
+	writecstring(f, dockmonitorname);
+	fputs(";\n\n", f);
+
+	if(rules) {
+		fputs("static const Rule staticrules[] = {\n", f);
+		for(i = 0, r = rules; r; r = r->next, ++i) {
+			fputs("\t{ .class = ", f);
+			writecstring(f, r->class);
+			fputs(", .instance = ", f);
+			writecstring(f, r->instance);
+			fputs(", .title = ", f);
+			writecstring(f, r->title);
+			fprintf(f, ", .tags = 0x%x, .isfloating = %d, .iscenter = %d, .isterminal = %d,"
+			        " .istransparent = %.17g, .nofocus = %d, .exfocus = %d, .noborder = %d,"
+			        " .rh = %d, .monitor = %d, .monitorname = ",
+			        r->tags, r->isfloating, r->iscenter, r->isterminal, r->istransparent,
+			        r->nofocus, r->exfocus, r->noborder, r->rh, r->monitor);
+			writecstring(f, r->monitorname);
+			fputs(", .remap = ", f);
+			writeremap(f, r->remap);
+			fputs(", .preflayout = ", f);
+			writelayout(f, r->preflayout);
+			fprintf(f, ", .istransient = %d, .isfullscreen = %d, .showdock = %d, .procname = ",
+			        r->istransient, r->isfullscreen, r->showdock);
+			writecstring(f, r->procname);
+			fprintf(f, ", .picomfreeze = %d, ", r->picomfreeze);
+			if(r->next)
+				fprintf(f, ".next = (Rule *)&staticrules[%d] },\n", i + 1);
+			else
+				fputs(".next = NULL },\n", f);
+		}
+		fputs("};\nstatic Rule *const staticrulelist = (Rule *)&staticrules[0];\n\n", f);
+	}
+	else
+		fputs("static Rule *const staticrulelist = NULL;\n\n", f);
+
+	if(keys) {
+		fputs("static const Key statickeys[] = {\n", f);
+		for(i = 0, k = keys; k; k = k->next, ++i) {
+			fprintf(f, "\t{ .mod = 0x%x, .keysym = 0x%lx /* %s */, .func = ",
+			        k->mod, k->keysym, k->keysym ? XKeysymToString(k->keysym) : "NoSymbol");
+			writefunction(f, k->func);
+			fputs(", .arg = ", f);
+			writearg(f, k->func, &k->arg, False);
+			if(k->next)
+				fprintf(f, ", .next = (Key *)&statickeys[%d] },\n", i + 1);
+			else
+				fputs(", .next = NULL },\n", f);
+		}
+		fputs("};\nstatic Key *const statickeylist = (Key *)&statickeys[0];\n\n", f);
+	}
+	else
+		fputs("static Key *const statickeylist = NULL;\n\n", f);
+
+	if(buttons) {
+		fputs("static const Button staticbuttons[] = {\n", f);
+		for(i = 0, b = buttons; b; b = b->next, ++i) {
+			fprintf(f, "\t{ .click = %u, .mask = 0x%x, .button = %u, .func = ",
+			        b->click, b->mask, b->button);
+			writefunction(f, b->func);
+			fputs(", .arg = ", f);
+			writearg(f, b->func, &b->arg, True);
+			if(b->next)
+				fprintf(f, ", .next = (Button *)&staticbuttons[%d] },\n", i + 1);
+			else
+				fputs(", .next = NULL },\n", f);
+		}
+		fputs("};\nstatic Button *const staticbuttonlist = (Button *)&staticbuttons[0];\n", f);
+	}
+	else
+		fputs("static Button *const staticbuttonlist = NULL;\n", f);
+	fclose(f);
+}
@@ -0,0 +1,96 @@
+#ifdef STATS
+/* Send SIGUSR1 to dwm to have the counters written to statsfile as JSON.
+ * The dump happens on the next event the main loop wakes up for. */
+static const char *eventnames[LASTEvent] = {
+	[ButtonPress] = "ButtonPress",
+	[ButtonRelease] = "ButtonRelease",
+	[ClientMessage] = "ClientMessage",
+	[ConfigureRequest] = "ConfigureRequest",
+	[ConfigureNotify] = "ConfigureNotify",
+	[DestroyNotify] = "DestroyNotify",
+	[EnterNotify] = "EnterNotify",
+	[Expose] = "Expose",
+	[FocusIn] = "FocusIn",
+	[KeyPress] = "KeyPress",
+	[KeyRelease] = "KeyRelease",
+	[MappingNotify] = "MappingNotify",
+	[MapRequest] = "MapRequest",
+	[MotionNotify] = "MotionNotify",
+	[PropertyNotify] = "PropertyNotify",
+	[ResizeRequest] = "ResizeRequest",
+	[UnmapNotify] = "UnmapNotify"
+};
+
+unsigned long long
+statsnow(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void
+statsinit(void) {
+	stats.started = statsnow();
+	sigstats(0);
+	statsdump = 0;
+}
+
+void
+sigstats(int unused) {
+	if(signal(SIGUSR1, sigstats) == SIG_ERR)
+		die("Can't install SIGUSR1 handler");
+	statsdump = 1;
+}
+
+void
+statsevent(int type) {
+	HandlerStats *h = &stats.handlers[type];
+	unsigned long long dt = statsnow() - stats.evstart;
+	unsigned long long us = dt / 1000;
+	int b;
+
+	for(b = 0; us && b < STATSBUCKETS - 1; ++b)
+		us >>= 1;
+	h->buckets[b]++;
+	h->count++;
+	h->total += dt;
+	h->max = MAX(h->max, dt);
+	h->requests += NextRequest(dpy) - stats.evrequest;
+}
+
+void
+dumpstats(void) {
+	FILE *f;
+	HandlerStats *h;
+	int i, b;
+	const char *sep = "";
+
+	statsdump = 0;
+	if(!(f = fopen(statsfile, "w"))) {
+		fprintf(stderr, "dwm: cannot write %s\n", statsfile);
+		return;
+	}
+	fprintf(f, "{\n\t\"uptime_ms\": %llu,\n", (statsnow() - stats.started) / 1000000);
+	fprintf(f, "\t\"requests\": %lu,\n", NextRequest(dpy) - 1);
+	fprintf(f, "\t\"roundtrips\": %lu,\n\t\"xsyncs\": %lu,\n", stats.roundtrips, stats.xsyncs);
+	fprintf(f, "\t\"arrange\": %lu,\n\t\"drawbar\": %lu,\n\t\"restackwindows\": %lu,\n",
+			stats.arranges, stats.drawbars, stats.restacks);
+	fprintf(f, "\t\"pango\": { \"calls\": %lu, \"total_us\": %llu },\n",
+			stats.pangocalls, stats.pangotime / 1000);
+	fprintf(f, "\t\"handlers\": {");
+	for(i = 0; i < LASTEvent; ++i) {
+		h = &stats.handlers[i];
+		if(!h->count || !eventnames[i])
+			continue;
+		fprintf(f, "%s\n\t\t\"%s\": { \"count\": %lu, \"requests\": %lu, \"total_us\": %llu, \"max_us\": %llu, \"histogram_log2_us\": [",
+				sep, eventnames[i], h->count, h->requests, h->total / 1000, h->max / 1000);
+		for(b = 0; b < STATSBUCKETS; ++b)
+			fprintf(f, b ? ", %lu" : "%lu", h->buckets[b]);
+		fprintf(f, "] }");
+		sep = ",";
+	}
+	fprintf(f, "\n\t}\n}\n");
+	fclose(f);
+}
+#endif /* STATS */
@@ -0,0 +1,66 @@
+/* Optional instrumentation, enabled by building with -DSTATS (see config.mk).
+ * Without it every hook below expands to nothing. */
+#ifdef STATS
+#include <time.h>
+
+#define STATSBUCKETS 16 /* log2 buckets in microseconds, the last is open ended */
+
+typedef struct {
+	unsigned long count;
+	unsigned long requests;         /* X requests issued by the handler */
+	unsigned long long total, max;  /* nanoseconds */
+	unsigned long buckets[STATSBUCKETS];
+} HandlerStats;
+
+typedef struct {
+	HandlerStats handlers[LASTEvent];
+	unsigned long xsyncs, roundtrips;
+	unsigned long arranges, drawbars, restacks;
+	unsigned long pangocalls;
+	unsigned long long pangotime, pangostart;
+	unsigned long long started, evstart;
+	unsigned long evrequest;
+} Stats;
+
+static Stats stats;
+static volatile sig_atomic_t statsdump = 0;
+
+static unsigned long long statsnow(void);
+static void statsinit(void);
+static void statsevent(int type);
+static void dumpstats(void);
+static void sigstats(int unused);
+
+#define STATS_INIT()            statsinit()
+#define STATS_COUNT(counter)    (++stats.counter)
+#define STATS_EVENT_BEGIN()     (stats.evstart = statsnow(), stats.evrequest = NextRequest(dpy))
+#define STATS_EVENT_END(type)   statsevent(type)
+#define STATS_PANGO_BEGIN()     (stats.pangostart = statsnow())
+#define STATS_PANGO_END()       (++stats.pangocalls, stats.pangotime += statsnow() - stats.pangostart)
+#define STATS_POLL()            (statsdump ? dumpstats() : (void)0)
+
+/* Xlib calls that wait for a reply */
+#define XSync(...)                  (++stats.xsyncs, ++stats.roundtrips, XSync(__VA_ARGS__))
+#define XInternAtom(...)            (++stats.roundtrips, XInternAtom(__VA_ARGS__))
+#define XGetAtomName(...)           (++stats.roundtrips, XGetAtomName(__VA_ARGS__))
+#define XGetWindowProperty(...)     (++stats.roundtrips, XGetWindowProperty(__VA_ARGS__))
+#define XGetWindowAttributes(...)   (++stats.roundtrips, XGetWindowAttributes(__VA_ARGS__))
+#define XGetTransientForHint(...)   (++stats.roundtrips, XGetTransientForHint(__VA_ARGS__))
+#define XGetTextProperty(...)       (++stats.roundtrips, XGetTextProperty(__VA_ARGS__))
+#define XGetClassHint(...)          (++stats.roundtrips, XGetClassHint(__VA_ARGS__))
+#define XGetWMHints(...)            (++stats.roundtrips, XGetWMHints(__VA_ARGS__))
+#define XGetWMNormalHints(...)      (++stats.roundtrips, XGetWMNormalHints(__VA_ARGS__))
+#define XGetWMProtocols(...)        (++stats.roundtrips, XGetWMProtocols(__VA_ARGS__))
+#define XGetSelectionOwner(...)     (++stats.roundtrips, XGetSelectionOwner(__VA_ARGS__))
+#define XQueryTree(...)             (++stats.roundtrips, XQueryTree(__VA_ARGS__))
+#define XQueryPointer(...)          (++stats.roundtrips, XQueryPointer(__VA_ARGS__))
+#define XGrabPointer(...)           (++stats.roundtrips, XGrabPointer(__VA_ARGS__))
+#else
+#define STATS_INIT()            ((void)0)
+#define STATS_COUNT(counter)    ((void)0)
+#define STATS_EVENT_BEGIN()     ((void)0)
+#define STATS_EVENT_END(type)   ((void)0)
+#define STATS_PANGO_BEGIN()     ((void)0)
+#define STATS_PANGO_END()       ((void)0)
+#define STATS_POLL()            ((void)0)
+#endif /* STATS */
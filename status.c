@@ -0,0 +1,130 @@
+/* Built-in status bar text.
+ *
+ * With usestatusmodules the status area is made of the segments of
+ * statusmodules[] instead of the root window name. Every module has its own
+ * timerfd, polled from run(); a tick re-reads that module only and, when its
+ * width did not change, repaints just its segment of each bar. A width
+ * change shifts the other segments, so the bars are redrawn as a whole. */
+#define STATUSLEN 64
+
+static char statustext[LENGTH(statusmodules)][STATUSLEN];
+static int statusw[LENGTH(statusmodules)];
+static int statusfds[LENGTH(statusmodules)];
+
+int
+statuswidth(void) {
+	int i, w = 0;
+
+	if(!usestatusmodules)
+		return TEXTW(stext);
+	for(i = 0; i < LENGTH(statusmodules); ++i)
+		w += statusw[i];
+	return w;
+}
+
+/* draws the segments from dc.x on, leaves dc.x where it was */
+void
+drawstatus(void) {
+	int i, x = dc.x;
+
+	for(i = 0; i < LENGTH(statusmodules); ++i)
+		if(statusw[i]) {
+			dc.w = statusw[i];
+			drawtext(statustext[i], dc.norm, False, False);
+			dc.x += dc.w;
+		}
+	dc.x = x;
+}
+
+static void
+drawstatussegment(Monitor *m, int i) {
+	int j, x = m->statusx;
+
+	for(j = 0; j < i; ++j)
+		x += statusw[j];
+	dc.x = x;
+	dc.w = statusw[i];
+	drawtext(statustext[i], dc.norm, False, False);
+	XCopyArea(dpy, dc.drawable, m->barwin, dc.gc, x, 0, dc.w, bh, x, 0);
+}
+
+static void
+armstatus(int i) {
+	struct itimerspec its = { { statusmodules[i].interval, 0 }, { statusmodules[i].interval, 0 } };
+	time_t period = statusmodules[i].interval;
+
+	if(statusmodules[i].wallclock) {
+		its.it_value.tv_sec = (time(NULL) / period + 1) * period;
+		its.it_interval.tv_sec = 0;
+		timerfd_settime(statusfds[i], TFD_TIMER_ABSTIME, &its, NULL);
+	}
+	else
+		timerfd_settime(statusfds[i], 0, &its, NULL);
+}
+
+static void
+updatestatusmodule(int i) {
+	char text[STATUSLEN];
+	Monitor *m;
+	int w;
+	Bool redraw = False;
+
+	statusmodules[i].read(text, sizeof text);
+	if(!strcmp(text, statustext[i]))
+		return;
+	strcpy(statustext[i], text);
+	w = *text ? TEXTW(text) : 0;
+	redraw = w != statusw[i];
+	statusw[i] = w;
+	for(m = mons; m; m = m->next) {
+		if((m != selmon && !statusallmonitor) || m->fullscreenwin)
+			continue;
+		if(redraw || m->statusx < 0)
+			drawbar(m);
+		else if(w)
+			drawstatussegment(m, i);
+	}
+}
+
+void
+tickstatus(int i) {
+	uint64_t expirations;
+
+	if(read(statusfds[i], &expirations, sizeof expirations) != sizeof expirations)
+		return;
+	updatestatusmodule(i);
+	if(statusmodules[i].wallclock)
+		armstatus(i);
+	/* the colors follow the wallpaper; the first module, whichever it is,
+	 * checks for a new one in place of the root window name updates */
+	if(i == 0)
+		checkconfigtimes();
+	XFlush(dpy);
+}
+
+void
+startstatus(void) {
+	int i;
+
+	for(i = 0; i < LENGTH(statusmodules); ++i) {
+		statusfds[i] = -1;
+		if(!usestatusmodules)
+			continue;
+		statusmodules[i].read(statustext[i], STATUSLEN);
+		statusw[i] = *statustext[i] ? TEXTW(statustext[i]) : 0;
+		if((statusfds[i] = timerfd_create(statusmodules[i].wallclock ? CLOCK_REALTIME : CLOCK_MONOTONIC,
+		                                  TFD_NONBLOCK|TFD_CLOEXEC)) != -1)
+			armstatus(i);
+	}
+}
+
+void
+stopstatus(void) {
+	int i;
+
+	for(i = 0; i < LENGTH(statusmodules); ++i)
+		if(statusfds[i] != -1) {
+			close(statusfds[i]);
+			statusfds[i] = -1;
+		}
+}
@@ -0,0 +1,146 @@
+/* Status modules, read straight from /proc and /sys.
+ *
+ * Each one writes its bar segment to buf, or an empty string to hide it.
+ * Counters are kept between calls, so rates cover the module's interval. */
+typedef struct {
+	void (*read)(char *buf, size_t size);
+	unsigned int interval;  /* seconds */
+	Bool wallclock;         /* fire on interval boundaries of the wall clock */
+} StatusModule;
+
+static void statusbattery(char *buf, size_t size);
+static void statuscpu(char *buf, size_t size);
+static void statusdate(char *buf, size_t size);
+static void statusload(char *buf, size_t size);
+static void statusmem(char *buf, size_t size);
+static void statusnet(char *buf, size_t size);
+
+static Bool
+readstatusfile(const char *path, char *buf, size_t size) {
+	FILE *f;
+	size_t n;
+
+	if(!(f = fopen(path, "r")))
+		return False;
+	n = fread(buf, 1, size - 1, f);
+	fclose(f);
+	buf[n] = '\0';
+	return n > 0;
+}
+
+static void
+humanbytes(char *buf, size_t size, double n) {
+	const char units[] = "BKMGT";
+	int i;
+
+	for(i = 0; n >= 1000 && i < sizeof units - 2; ++i)
+		n /= 1024;
+	snprintf(buf, size, n < 10 && i ? "%.1f%c" : "%.0f%c", n, units[i]);
+}
+
+static double
+statusseconds(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void
+statuscpu(char *buf, size_t size) {
+	static unsigned long long lastbusy, lasttotal;
+	unsigned long long v[8], busy, total;
+	char line[256];
+
+	if(!readstatusfile("/proc/stat", line, sizeof line)
+	|| sscanf(line, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+	          &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) != 8) {
+		*buf = '\0';
+		return;
+	}
+	/* idle and iowait are not busy */
+	total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+	busy = total - v[3] - v[4];
+	snprintf(buf, size, "cpu %llu%%", total > lasttotal ? 100 * (busy - lastbusy) / (total - lasttotal) : 0);
+	lastbusy = busy;
+	lasttotal = total;
+}
+
+void
+statusmem(char *buf, size_t size) {
+	unsigned long total = 0, avail = 0;
+	char text[1024], *p;
+
+	*buf = '\0';
+	if(!readstatusfile("/proc/meminfo", text, sizeof text))
+		return;
+	if((p = strstr(text, "MemTotal:")))
+		sscanf(p, "MemTotal: %lu", &total);
+	if((p = strstr(text, "MemAvailable:")))
+		sscanf(p, "MemAvailable: %lu", &avail);
+	if(total)
+		snprintf(buf, size, "mem %lu%%", 100 * (total - avail) / total);
+}
+
+void
+statusload(char *buf, size_t size) {
+	char text[128];
+	double load;
+
+	*buf = '\0';
+	if(readstatusfile("/proc/loadavg", text, sizeof text) && sscanf(text, "%lf", &load) == 1)
+		snprintf(buf, size, "load %.2f", load);
+}
+
+void
+statusbattery(char *buf, size_t size) {
+	char capacity[16], status[32];
+	int percent;
+
+	*buf = '\0';
+	if(!readstatusfile("/sys/class/power_supply/BAT0/capacity", capacity, sizeof capacity)
+	|| sscanf(capacity, "%d", &percent) != 1)
+		return;
+	if(!readstatusfile("/sys/class/power_supply/BAT0/status", status, sizeof status))
+		*status = '\0';
+	snprintf(buf, size, "bat %d%%%s", percent,
+	         !strncmp(status, "Charging", 8) ? "+" : !strncmp(status, "Discharging", 11) ? "-" : "");
+}
+
+void
+statusnet(char *buf, size_t size) {
+	static double lastrx, lasttx, lasttime;
+	char line[512], iface[64], rxs[16], txs[16];
+	unsigned long long rx, tx;
+	double totalrx = 0, totaltx = 0, now, dt;
+	FILE *f;
+
+	*buf = '\0';
+	if(!(f = fopen("/proc/net/dev", "r")))
+		return;
+	while(fgets(line, sizeof line, f))
+		if(sscanf(line, " %63[^:]: %llu %*u %*u %*u %*u %*u %*u %*u %llu", iface, &rx, &tx) == 3
+		&& strcmp(iface, "lo")) {
+			totalrx += rx;
+			totaltx += tx;
+		}
+	fclose(f);
+	now = statusseconds();
+	dt = now - lasttime;
+	if(lasttime > 0 && dt > 0) {
+		humanbytes(rxs, sizeof rxs, (totalrx - lastrx) / dt);
+		humanbytes(txs, sizeof txs, (totaltx - lasttx) / dt);
+		snprintf(buf, size, "net %s/%s", rxs, txs);
+	}
+	lastrx = totalrx;
+	lasttx = totaltx;
+	lasttime = now;
+}
+
+void
+statusdate(char *buf, size_t size) {
+	time_t now = time(NULL);
+
+	if(!strftime(buf, size, "%a %d %b %H:%M", localtime(&now)))
+		*buf = '\0';
+}
@@ -0,0 +1,141 @@
+/* Prewarmed terminals.
+ *
+ * With termpoolsize > 0 that many terminals are started ahead of time. Their
+ * windows are told apart by the pid of the X client that asks to map them and
+ * are left unmapped and unmanaged. spawnterm() hands a ready one to manage(),
+ * which applies the rules, tags and maps it like any new window, then starts
+ * its replacement; with none ready it starts a terminal as before. Slots whose
+ * terminal died are refilled on the next spawnterm(), so a terminal that
+ * cannot start does not respawn in a loop. sigchld() marks a slot as soon as
+ * it reaps its pid, before the pid can be reused by another program. */
+typedef struct {
+	pid_t pid;    /* 0 for a free slot */
+	Window win;   /* None until the terminal asked to be mapped */
+	volatile sig_atomic_t reaped;
+} PoolTerm;
+
+static PoolTerm *poolterms = NULL;
+static int npending = 0;      /* started, window not seen yet */
+
+/* keeps sigchld() off poolterms while slots change, so a terminal that dies
+ * right after forkterm() is still seen */
+static void
+blockchld(Bool block) {
+	sigset_t set;
+
+	sigemptyset(&set);
+	sigaddset(&set, SIGCHLD);
+	sigprocmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+static void
+fillpool(void) {
+	int i;
+
+	blockchld(True);
+	for(i = 0; i < termpoolsize; ++i) {
+		if(poolterms[i].pid && poolterms[i].reaped) {
+			if(poolterms[i].win == None)
+				--npending;
+			poolterms[i].pid = 0;
+			poolterms[i].win = None;
+		}
+		if(poolterms[i].pid)
+			continue;
+		poolterms[i].reaped = 0;
+		if((poolterms[i].pid = forkterm()) > 0)
+			++npending;
+		else
+			poolterms[i].pid = 0;
+	}
+	blockchld(False);
+}
+
+/* called from sigchld() */
+void
+reappoolterm(pid_t pid) {
+	int i;
+
+	for(i = 0; poolterms && i < termpoolsize; ++i)
+		if(poolterms[i].pid == pid)
+			poolterms[i].reaped = 1;
+}
+
+void
+starttermpool(void) {
+	PoolTerm *p;
+
+	if(!termpoolsize || poolterms)
+		return;
+	if(!(p = (PoolTerm *)calloc(termpoolsize, sizeof(PoolTerm))))
+		die("fatal: could not malloc() %u bytes\n", termpoolsize * sizeof(PoolTerm));
+	poolterms = p;
+	fillpool();
+}
+
+void
+stoptermpool(void) {
+	int i;
+
+	if(!poolterms)
+		return;
+	blockchld(True);
+	for(i = 0; i < termpoolsize; ++i)
+		if(poolterms[i].pid && !poolterms[i].reaped)
+			kill(poolterms[i].pid, SIGHUP);
+	free(poolterms);
+	poolterms = NULL;
+	npending = 0;
+	blockchld(False);
+}
+
+/* called on map requests of unmanaged windows, True keeps w in the pool */
+Bool
+pooltermwindow(Window w) {
+	pid_t pid;
+	int i;
+
+	if(!npending || !(pid = winpid(w)))
+		return False;
+	for(i = 0; i < termpoolsize; ++i)
+		if(poolterms[i].pid == pid && poolterms[i].win == None && !poolterms[i].reaped) {
+			poolterms[i].win = w;
+			--npending;
+			return True;
+		}
+	return False;
+}
+
+void
+droppoolterm(Window w) {
+	int i;
+
+	for(i = 0; poolterms && i < termpoolsize; ++i)
+		if(poolterms[i].win == w) {
+			poolterms[i].pid = 0;
+			poolterms[i].win = None;
+		}
+}
+
+/* manages a ready terminal, False when there is none */
+Bool
+claimpoolterm(void) {
+	XWindowAttributes wa;
+	Window w;
+	int i;
+
+	for(i = 0; poolterms && i < termpoolsize; ++i) {
+		if(!(w = poolterms[i].win) || poolterms[i].reaped)
+			continue;
+		poolterms[i].pid = 0;
+		poolterms[i].win = None;
+		if(!XGetWindowAttributes(dpy, w, &wa) || wintoclient(w))
+			continue;
+		manage(w, &wa);
+		fillpool();
+		return True;
+	}
+	if(poolterms)
+		fillpool();
+	return False;
+}
@@ -0,0 +1,90 @@
+/* Lazy, rate limited window titles.
+ *
+ * A WM_NAME or _NET_WM_NAME change only marks the title stale; the property
+ * is read by clienttitle() when the bar (or a rule) actually needs it, so
+ * titles of unselected clients are never fetched while they churn. Title
+ * repaints of a monitor are capped at titlerate per second: a change inside
+ * the interval is held until a one-shot timerfd, polled in run(), fires at
+ * the earliest due monitor, and then repaints only the title segment. */
+static int titlefd = -1;
+
+static long long
+titlenow(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+const char *
+clienttitle(Client *c) {
+	if(c->titlestale) {
+		c->titlestale = False;
+		updatetitle(c);
+	}
+	return c->info->name;
+}
+
+static void
+armtitles(long long now) {
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+	long long due = 0;
+	Monitor *m;
+
+	for(m = mons; m; m = m->next)
+		if(m->titlewaiting && (!due || m->titledrawn + 1000 / titlerate < due))
+			due = m->titledrawn + 1000 / titlerate;
+	if(!due)
+		return;
+	due = MAX(due - now, 1);
+	its.it_value.tv_sec = due / 1000;
+	its.it_value.tv_nsec = due % 1000 * 1000000;
+	timerfd_settime(titlefd, 0, &its, NULL);
+}
+
+static void
+scheduletitle(Monitor *m) {
+	long long now = titlenow();
+
+	if(titlerate <= 0 || now >= m->titledrawn + 1000 / titlerate
+	|| (titlefd == -1 && (titlefd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC)) == -1)) {
+		m->titledrawn = now;
+		markdirty(m, DirtyTitle);
+		return;
+	}
+	if(m->titlewaiting)
+		return;
+	m->titlewaiting = True;
+	armtitles(now);
+}
+
+void
+titlechanged(Client *c) {
+	c->titlestale = True;
+	if(c == c->mon->sel)
+		scheduletitle(c->mon);
+}
+
+void
+ticktitles(void) {
+	uint64_t expirations;
+	long long now = titlenow();
+	Monitor *m;
+
+	if(read(titlefd, &expirations, sizeof expirations) != sizeof expirations)
+		return;
+	for(m = mons; m; m = m->next)
+		if(m->titlewaiting && now >= m->titledrawn + 1000 / titlerate) {
+			m->titlewaiting = False;
+			m->titledrawn = now;
+			markdirty(m, DirtyTitle);
+		}
+	armtitles(now);
+}
+
+void
+stoptitles(void) {
+	if(titlefd != -1)
+		close(titlefd);
+	titlefd = -1;
+}
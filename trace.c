@@ -0,0 +1,397 @@
+/* Event traces.
+ *
+ * dwm -r <file> records every event run() dispatches, dwm -p <file> feeds a
+ * recording back through handler[] on the current display and reports the
+ * time spent in the handlers and the X requests they issued.
+ *
+ * A trace is a TraceHeader followed by records. A record is a TraceRecord,
+ * the raw XEvent, the names of the atoms the event refers to and the window
+ * properties the handler is going to read. Properties are captured at record
+ * time since the windows are long gone when the trace is replayed; replay
+ * creates a stand-in window for every window it sees a MapRequest for and
+ * translates atoms by name. Events for windows it does not know, like the
+ * bars of the recording session, get None as their window. */
+#define TRACEMAGIC   0x746d7764 /* "dwmt" */
+#define TRACEVERSION 1
+
+typedef struct {
+	uint32_t magic, version;
+	uint32_t eventsize; /* sizeof(XEvent) of the recording build */
+	uint64_t root;
+} TraceHeader;
+
+typedef struct {
+	uint64_t time; /* ns since recording started */
+	int32_t x, y, w, h, bw; /* window geometry, MapRequest only */
+	uint16_t natoms, nprops;
+} TraceRecord;
+
+typedef struct {
+	Atom name, type;
+	int format;
+	unsigned long nitems;
+	unsigned char *data;
+} TraceProp;
+
+typedef struct {
+	Window recorded, replayed;
+} TraceWindow;
+
+/* properties manage() looks at */
+static const char *tracepropnames[] = {
+	"WM_NAME", "_NET_WM_NAME", "WM_CLASS", "WM_HINTS", "WM_NORMAL_HINTS",
+	"WM_TRANSIENT_FOR", "WM_PROTOCOLS", "_NET_WM_WINDOW_TYPE", "_NET_WM_STATE",
+	"_MOTIF_WM_HINTS",
+};
+static Atom traceprops[LENGTH(tracepropnames)];
+static FILE *trace = NULL;
+static uint64_t tracestart;
+static Window traceroot;
+static TraceWindow *tracewins = NULL;
+static int ntracewins = 0;
+
+uint64_t
+tracenow(void) {
+	struct timespec ts;
+
+	/* monotonic, a clock step while recording must not warp the gaps */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+size_t
+tracepropsize(int format) {
+	return format == 32 ? sizeof(long) : format / 8;
+}
+
+/* event fields holding atoms; a _NET_WM_STATE message names its states in
+ * data.l[1] and data.l[2] */
+int
+traceeventatoms(XEvent *ev, Atom **atoms) {
+	switch(ev->type) {
+	case PropertyNotify:
+		atoms[0] = &ev->xproperty.atom;
+		return 1;
+	case ClientMessage:
+		atoms[0] = &ev->xclient.message_type;
+		if(ev->xclient.format != 32 || ev->xclient.message_type != netatom[NetWMState])
+			return 1;
+		atoms[1] = (Atom *)&ev->xclient.data.l[1];
+		atoms[2] = (Atom *)&ev->xclient.data.l[2];
+		return 3;
+	}
+	return 0;
+}
+
+/* event fields holding windows, the one the event is about first */
+int
+traceeventwindows(XEvent *ev, Window **wins) {
+	switch(ev->type) {
+	case MapRequest:
+		wins[0] = &ev->xmaprequest.window;
+		wins[1] = &ev->xmaprequest.parent;
+		return 2;
+	case ConfigureRequest:
+		wins[0] = &ev->xconfigurerequest.window;
+		wins[1] = &ev->xconfigurerequest.parent;
+		wins[2] = &ev->xconfigurerequest.above;
+		return 3;
+	case ConfigureNotify:
+		wins[0] = &ev->xconfigure.window;
+		wins[1] = &ev->xconfigure.event;
+		wins[2] = &ev->xconfigure.above;
+		return 3;
+	case DestroyNotify:
+		wins[0] = &ev->xdestroywindow.window;
+		wins[1] = &ev->xdestroywindow.event;
+		return 2;
+	case UnmapNotify:
+		wins[0] = &ev->xunmap.window;
+		wins[1] = &ev->xunmap.event;
+		return 2;
+	case KeyPress:
+	case KeyRelease:
+		wins[0] = &ev->xkey.window;
+		wins[1] = &ev->xkey.root;
+		wins[2] = &ev->xkey.subwindow;
+		return 3;
+	case ButtonPress:
+	case ButtonRelease:
+		wins[0] = &ev->xbutton.window;
+		wins[1] = &ev->xbutton.root;
+		wins[2] = &ev->xbutton.subwindow;
+		return 3;
+	case MotionNotify:
+		wins[0] = &ev->xmotion.window;
+		wins[1] = &ev->xmotion.root;
+		wins[2] = &ev->xmotion.subwindow;
+		return 3;
+	case EnterNotify:
+		wins[0] = &ev->xcrossing.window;
+		wins[1] = &ev->xcrossing.root;
+		wins[2] = &ev->xcrossing.subwindow;
+		return 3;
+	}
+	wins[0] = &ev->xany.window;
+	return 1;
+}
+
+void
+tracewritestr(const char *s) {
+	uint16_t len = s ? strlen(s) : 0;
+
+	fwrite(&len, sizeof len, 1, trace);
+	fwrite(s, 1, len, trace);
+}
+
+void
+tracewriteatom(Atom a) {
+	char *name = a ? XGetAtomName(dpy, a) : NULL;
+
+	tracewritestr(name);
+	if(name)
+		XFree(name);
+}
+
+Bool
+tracefetchprop(Window w, Atom name, TraceProp *p) {
+	unsigned long after;
+
+	p->name = name;
+	p->data = NULL;
+	if(XGetWindowProperty(dpy, w, name, 0L, 65536L, False, AnyPropertyType,
+	                      &p->type, &p->format, &p->nitems, &after, &p->data) == Success
+	&& p->type != None)
+		return True;
+	if(p->data)
+		XFree(p->data);
+	return False;
+}
+
+void
+tracewriteprop(TraceProp *p) {
+	uint32_t format = p->format, nitems = p->nitems;
+	unsigned long i;
+
+	tracewriteatom(p->name);
+	tracewriteatom(p->type);
+	fwrite(&format, sizeof format, 1, trace);
+	fwrite(&nitems, sizeof nitems, 1, trace);
+	if(p->type == XA_ATOM)
+		for(i = 0; i < p->nitems; ++i)
+			tracewriteatom(((Atom *)p->data)[i]);
+	else
+		fwrite(p->data, tracepropsize(p->format), p->nitems, trace);
+	XFree(p->data);
+}
+
+void
+recordevent(XEvent *ev) {
+	TraceRecord r = { 0 };
+	TraceProp props[LENGTH(traceprops)];
+	XWindowAttributes wa;
+	Atom *atoms[3];
+	int i;
+
+	r.time = tracenow() - tracestart;
+	r.natoms = traceeventatoms(ev, atoms);
+	if(ev->type == MapRequest) {
+		if(XGetWindowAttributes(dpy, ev->xmaprequest.window, &wa)) {
+			r.x = wa.x;
+			r.y = wa.y;
+			r.w = wa.width;
+			r.h = wa.height;
+			r.bw = wa.border_width;
+		}
+		for(i = 0; i < LENGTH(traceprops); ++i)
+			if(tracefetchprop(ev->xmaprequest.window, traceprops[i], &props[r.nprops]))
+				r.nprops++;
+	}
+	else if(ev->type == PropertyNotify && ev->xproperty.state == PropertyNewValue
+	&& tracefetchprop(ev->xproperty.window, ev->xproperty.atom, &props[0]))
+		r.nprops = 1;
+	fwrite(&r, sizeof r, 1, trace);
+	fwrite(ev, sizeof(XEvent), 1, trace);
+	for(i = 0; i < r.natoms; ++i)
+		tracewriteatom(*atoms[i]);
+	for(i = 0; i < r.nprops; ++i)
+		tracewriteprop(&props[i]);
+}
+
+void
+startrecording(const char *path) {
+	TraceHeader h = { TRACEMAGIC, TRACEVERSION, sizeof(XEvent), root };
+	XEvent ev = { 0 };
+	Monitor *m;
+	Client *c;
+	int i;
+
+	if(!(trace = fopen(path, "wb")))
+		die("dwm: cannot open %s\n", path);
+	for(i = 0; i < LENGTH(traceprops); ++i)
+		traceprops[i] = XInternAtom(dpy, tracepropnames[i], False);
+	tracestart = tracenow();
+	fwrite(&h, sizeof h, 1, trace);
+	/* clients managed before recording started are replayed as mapped first */
+	ev.type = MapRequest;
+	ev.xmaprequest.parent = root;
+	for(m = mons; m; m = m->next)
+		for(c = m->clients; c; c = c->next) {
+			ev.xmaprequest.window = c->win;
+			recordevent(&ev);
+		}
+}
+
+void
+stoprecording(void) {
+	if(!trace)
+		return;
+	fclose(trace);
+	trace = NULL;
+}
+
+char *
+tracereadstr(FILE *f) {
+	uint16_t len;
+	char *s;
+
+	if(fread(&len, sizeof len, 1, f) != 1 || !len)
+		return NULL;
+	if(!(s = (char *)malloc(len + 1)))
+		die("fatal: could not malloc() %u bytes\n", len + 1);
+	s[fread(s, 1, len, f)] = '\0';
+	return s;
+}
+
+Atom
+tracereadatom(FILE *f) {
+	char *name = tracereadstr(f);
+	Atom a = name ? XInternAtom(dpy, name, False) : None;
+
+	free(name);
+	return a;
+}
+
+Window
+tracewindow(Window recorded) {
+	int i;
+
+	if(recorded == traceroot)
+		return root;
+	for(i = 0; i < ntracewins; ++i)
+		if(tracewins[i].recorded == recorded)
+			return tracewins[i].replayed;
+	return None;
+}
+
+Window
+createtracewindow(Window recorded, TraceRecord *r) {
+	Window w = XCreateSimpleWindow(dpy, root, r->x, r->y, MAX(r->w, 1), MAX(r->h, 1), r->bw, 0, 0);
+
+	if(!(tracewins = (TraceWindow *)realloc(tracewins, (ntracewins + 1) * sizeof(TraceWindow))))
+		die("fatal: could not malloc() %u bytes\n", (ntracewins + 1) * sizeof(TraceWindow));
+	tracewins[ntracewins].recorded = recorded;
+	tracewins[ntracewins++].replayed = w;
+	return w;
+}
+
+void
+destroytracewindow(Window replayed) {
+	int i;
+
+	for(i = 0; i < ntracewins; ++i)
+		if(tracewins[i].replayed == replayed) {
+			XDestroyWindow(dpy, replayed);
+			tracewins[i] = tracewins[--ntracewins];
+			return;
+		}
+}
+
+void
+replayprop(FILE *f, Window w) {
+	Atom name = tracereadatom(f), type = tracereadatom(f);
+	uint32_t format = 0, nitems = 0, i;
+	unsigned char *data;
+
+	if(fread(&format, sizeof format, 1, f) != 1 || fread(&nitems, sizeof nitems, 1, f) != 1)
+		return;
+	if(!(data = (unsigned char *)calloc(MAX(nitems, 1), tracepropsize(format))))
+		die("fatal: could not malloc() %u bytes\n", nitems * tracepropsize(format));
+	if(type == XA_ATOM)
+		for(i = 0; i < nitems; ++i)
+			((Atom *)data)[i] = tracereadatom(f);
+	else if(fread(data, tracepropsize(format), nitems, f) != nitems)
+		nitems = 0;
+	if(type == XA_WINDOW)
+		for(i = 0; i < nitems; ++i)
+			((Window *)data)[i] = tracewindow(((Window *)data)[i]);
+	if(w)
+		XChangeProperty(dpy, w, name, type, format, PropModeReplace, data, nitems);
+	free(data);
+}
+
+void
+replay(const char *path) {
+	FILE *f;
+	TraceHeader h;
+	TraceRecord r;
+	XEvent ev, live;
+	Atom names[3], *atoms[3];
+	Window *wins[3], w;
+	unsigned long events = 0, handled = 0, requests = 0, start;
+	uint64_t elapsed = 0, t;
+	int i, n;
+
+	if(!(f = fopen(path, "rb")))
+		die("dwm: cannot open %s\n", path);
+	if(fread(&h, sizeof h, 1, f) != 1 || h.magic != TRACEMAGIC
+	|| h.version != TRACEVERSION || h.eventsize != sizeof(XEvent))
+		die("dwm: %s is not a trace recorded by this build\n", path);
+	traceroot = h.root;
+	while(fread(&r, sizeof r, 1, f) == 1 && fread(&ev, sizeof ev, 1, f) == 1) {
+		if(r.natoms > LENGTH(names) || r.nprops > LENGTH(traceprops))
+			die("dwm: %s is corrupt\n", path);
+		events++;
+		for(i = 0; i < r.natoms; ++i) {
+			names[i] = tracereadatom(f);
+			/* message_type decides which data.l atoms come next */
+			if(i < traceeventatoms(&ev, atoms))
+				*atoms[i] = names[i];
+		}
+		n = traceeventwindows(&ev, wins);
+		if(ev.type == MapRequest && !tracewindow(*wins[0]))
+			createtracewindow(*wins[0], &r);
+		w = tracewindow(*wins[0]);
+		for(i = 0; i < r.nprops; ++i)
+			replayprop(f, w);
+		for(i = 0; i < n; ++i)
+			*wins[i] = tracewindow(*wins[i]);
+		if(ev.type == PropertyNotify && ev.xproperty.state == PropertyDelete && w)
+			XDeleteProperty(dpy, w, ev.xproperty.atom);
+		else if(ev.type == UnmapNotify && !ev.xunmap.send_event && w)
+			XUnmapWindow(dpy, w);
+		else if(ev.type == DestroyNotify && w)
+			destroytracewindow(w);
+		/* the trace drives dwm, not the server */
+		XSync(dpy, False);
+		while(XPending(dpy))
+			XNextEvent(dpy, &live);
+		if(ev.type < LASTEvent && handler[ev.type]) {
+			start = NextRequest(dpy);
+			t = tracenow();
+			STATS_EVENT_BEGIN();
+			handler[ev.type](&ev);
+			STATS_EVENT_END(ev.type);
+			elapsed += tracenow() - t;
+			requests += NextRequest(dpy) - start;
+			handled++;
+		}
+	}
+	fclose(f);
+	fprintf(stderr, "dwm: replayed %lu of %lu events, %.3f ms in handlers, %lu requests\n",
+	        handled, events, elapsed / 1e6, requests);
+#ifdef STATS
+	dumpstats();
+#endif /* STATS */
+	free(tracewins);
+}